@@ -2,36 +2,333 @@
 #include <algorithm>
 #include <array>
 #include <execution>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
 #include <numeric>
+#include <tuple>
 #include <immintrin.h>
+#include "matrix.hpp"
+#include "meshOptimizer.hpp"
+#include "objLoader.hpp"
 #include "renderer.hpp"
 #include "version2/vectorclass.h"
+#include <Eigen/Dense>
 
-Renderer renderer;
+// Eigen vs matrix.hpp / vector.hpp on the operations of the geometry stage, the faster one is
+// selected with the RENDERER_SIMD_MATH option (see transform.hpp)
+namespace {
+constexpr size_t NUM_POINTS = 4096;
 
-static void SIMDVectorAddition(benchmark::State& state) {
-    Vec32uc a(10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10,
-              11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13);
-    Vec32uc b(10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10,
-              11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13);
+std::vector<Eigen::Vector3f> randomPoints() {
+    std::vector<Eigen::Vector3f> points(NUM_POINTS);
+    std::generate(points.begin(), points.end(), [] { return Eigen::Vector3f::Random(); });
+    return points;
+}
+
+mat4f_t toMat4(const Eigen::Matrix4f& m) {
+    mat4f_t result;
+    std::copy_n(m.data(), 16, result.data());  // both are column-major
+    return result;
+}
+}  // namespace
+
+static void EigenModelViewProduct(benchmark::State& state) {
+    Eigen::Matrix4f view = Eigen::Matrix4f::Random();
+    Eigen::Matrix4f world = Eigen::Matrix4f::Random();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(view);
+        Eigen::Matrix4f model_view = view * world;
+        benchmark::DoNotOptimize(model_view);
+    }
+}
+BENCHMARK(EigenModelViewProduct);
+
+static void SIMDModelViewProduct(benchmark::State& state) {
+    mat4f_t view = toMat4(Eigen::Matrix4f::Random());
+    mat4f_t world = toMat4(Eigen::Matrix4f::Random());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(view);
+        mat4f_t model_view = view * world;
+        benchmark::DoNotOptimize(model_view);
+    }
+}
+BENCHMARK(SIMDModelViewProduct);
+
+static void EigenTransformPoints(benchmark::State& state) {
+    auto points = randomPoints();
+    Eigen::Matrix4f model_view = Eigen::Matrix4f::Random();
+    for (auto _ : state) {
+        for (const auto& point : points) {
+            Eigen::Vector4f vec = model_view * Eigen::Vector4f{point.x(), point.y(), point.z(), 1.f};
+            benchmark::DoNotOptimize(vec);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_POINTS);
+}
+BENCHMARK(EigenTransformPoints);
+
+static void SIMDTransformPoints(benchmark::State& state) {
+    auto points = randomPoints();
+    mat4f_t model_view = toMat4(Eigen::Matrix4f::Random());
+    for (auto _ : state) {
+        for (const auto& point : points) {
+            vec4f_t vec = model_view * vec4f_t{point.x(), point.y(), point.z(), 1.f};
+            benchmark::DoNotOptimize(vec);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_POINTS);
+}
+BENCHMARK(SIMDTransformPoints);
+
+// projection followed by the perspective divide, like Renderer::project()
+static void EigenProjectPoints(benchmark::State& state) {
+    auto points = randomPoints();
+    Eigen::Matrix4f projection = Eigen::Matrix4f::Random();
+    for (auto _ : state) {
+        for (const auto& point : points) {
+            Eigen::Vector4f vec = projection * Eigen::Vector4f{point.x(), point.y(), point.z(), 1.f};
+            if (vec.w() != 0.f)
+                vec.head<3>() /= vec.w();
+            benchmark::DoNotOptimize(vec);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_POINTS);
+}
+BENCHMARK(EigenProjectPoints);
+
+static void SIMDProjectPoints(benchmark::State& state) {
+    auto points = randomPoints();
+    mat4f_t projection = toMat4(Eigen::Matrix4f::Random());
+    for (auto _ : state) {
+        for (const auto& point : points) {
+            vec4f_t vec = projection * vec4f_t{point.x(), point.y(), point.z(), 1.f};
+            if (vec.w() != 0.f) {
+                float w = vec.w();
+                vec.divide(w);
+                vec.w() = w;
+            }
+            benchmark::DoNotOptimize(vec);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_POINTS);
+}
+BENCHMARK(SIMDProjectPoints);
+
+// indexed vertex fetch of the geometry stage (transformed corners, face normal) on bunny.obj in
+// file order (Arg 0) and after the load-time vertex cache optimization (Arg 1)
+namespace {
+struct IndexedMesh {
+    std::vector<Eigen::Vector3f> vertices;
+    std::vector<Face> faces;
+};
+
+const IndexedMesh& benchmarkMesh(bool optimized) {
+    static const std::array<IndexedMesh, 2> meshes = [] {
+        std::array<IndexedMesh, 2> result;
+        loadObj(ASSETS_DIR "/bunny.obj", result[0].vertices, result[0].faces);
+        result[1] = result[0];
+        optimizeVertexCache(result[1].faces, result[1].vertices.size());
+        reorderVerticesByFirstUse(result[1].vertices, result[1].faces);
+        return result;
+    }();
+    return meshes[optimized];
+}
+}  // namespace
+
+static void FaceVertexFetch(benchmark::State& state) {
+    const auto& mesh = benchmarkMesh(state.range(0) != 0);
+    Eigen::Matrix4f model_view = Eigen::Matrix4f::Random();
+    std::vector<Eigen::Vector4f> transformed(mesh.vertices.size());
+    for (auto _ : state) {
+        for (size_t i{0}; i < mesh.vertices.size(); i++) {
+            transformed[i] = model_view * mesh.vertices[i].homogeneous();
+        }
+        for (const auto& face : mesh.faces) {
+            Eigen::Vector3f a = transformed[face.a].head<3>();
+            Eigen::Vector3f b = transformed[face.b].head<3>();
+            Eigen::Vector3f c = transformed[face.c].head<3>();
+            Eigen::Vector3f normal = (b - a).cross(c - a);
+            benchmark::DoNotOptimize(normal);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * mesh.faces.size());
+    state.counters["ACMR"] = averageCacheMissRatio(mesh.faces, mesh.vertices.size());
+}
+BENCHMARK(FaceVertexFetch)->Arg(0)->Arg(1);
+
+// the pipeline stages on every model in assets/, headless at fixed cameras and resolutions. they
+// are registered per model at startup, --benchmark_filter=Raster/bunny picks one model and stage
+namespace {
+struct BenchmarkCamera {
+    const char* name;
+    Vector3f position;
+};
+// the model is turned away from the axes, "near" is closer and off-center so it covers more of
+// the screen
+const std::array<BenchmarkCamera, 2> BENCHMARK_CAMERAS{{{"default", {0.f, 0.f, -2.f}},
+                                                        {"near", {0.3f, 0.2f, -1.2f}}}};
+const Vector3f BENCHMARK_MODEL_ROTATION{0.4f, 0.7f, 0.2f};
+constexpr std::array<std::pair<int, int>, 2> BENCHMARK_RESOLUTIONS{{{1280, 720}, {1920, 1080}}};
+constexpr std::array<const char*, 6> RENDER_MODE_NAMES{
+    "WIREFRAME", "WIREFRAME_VERTICES", "RASTERIZE", "RASTERIZE_WIREFRAME", "TEXTURE",
+    "TEXTURE_WIREFRAME"};
+
+std::vector<std::filesystem::path> benchmarkAssets() {
+    std::vector<std::filesystem::path> assets;
+    for (const auto& entry : std::filesystem::directory_iterator(ASSETS_DIR)) {
+        if (entry.path().extension() == ".obj")
+            assets.push_back(entry.path());
+    }
+    std::sort(assets.begin(), assets.end());
+    return assets;
+}
+
+size_t objFaceCount(const std::filesystem::path& obj_path) {
+    static std::map<std::filesystem::path, size_t> face_counts;
+    if (auto it = face_counts.find(obj_path); it != face_counts.end())
+        return it->second;
+    std::vector<Eigen::Vector3f> vertices;
+    std::vector<Face> faces;
+    loadObj(obj_path.string(), vertices, faces);
+    return face_counts[obj_path] = faces.size();
+}
+
+// offscreen renderer of the last benchmarkRenderer() call, released before the job system
+std::unique_ptr<Renderer> shared_renderer;
+
+// offscreen renderer showing obj_path from camera, kept for the following benchmarks of the same
+// setup so the raster modes do not load the model again
+Renderer& benchmarkRenderer(const std::filesystem::path& obj_path, int width, int height,
+                            const BenchmarkCamera& camera) {
+    static std::tuple<std::filesystem::path, int, int, const BenchmarkCamera*> current;
+    std::tuple setup{obj_path, width, height, &camera};
+    if (!shared_renderer || current != setup) {
+        shared_renderer.reset();
+        shared_renderer = std::make_unique<Renderer>();
+        // the setup messages of the renderer would end up between the results
+        auto* cout_buffer = std::cout.rdbuf(nullptr);
+        bool ready = shared_renderer->initializeOffscreen(width, height) &&
+                     shared_renderer->setupWindow(obj_path.string());
+        std::cout.rdbuf(cout_buffer);
+        if (!ready)
+            std::cerr << "Failed to set up the renderer for " << obj_path << '\n';
+        shared_renderer->setCamera(camera.position, 0.f, 0.f);
+        shared_renderer->setModelRotation(BENCHMARK_MODEL_ROTATION);
+        current = setup;
+    }
+    return *shared_renderer;
+}
+}  // namespace
+
+// OBJ parsing without the .rmesh sidecar
+static void ObjLoad(benchmark::State& state, const std::filesystem::path& obj_path) {
+    std::vector<Eigen::Vector3f> vertices;
+    std::vector<Face> faces;
     for (auto _ : state) {
-        Vec32uc c = a + b;  // Vector addition using VectorClass
+        vertices.clear();
+        faces.clear();
+        if (!loadObj(obj_path.string(), vertices, faces)) {
+            state.SkipWithError("failed to load the OBJ");
+            return;
+        }
+        benchmark::DoNotOptimize(faces.data());
     }
+    state.SetBytesProcessed(state.iterations() * std::filesystem::file_size(obj_path));
+    state.counters["triangles"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * faces.size()), benchmark::Counter::kIsRate);
 }
-BENCHMARK(SIMDVectorAddition);
 
-static void vectorAddition(benchmark::State& state) {
-    std::vector<int> a{10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13,
-                       10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13};
-    std::vector<int> b{10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12,
-                       13, 10, 11, 12, 13, 10, 11, 12, 13, 10, 11, 12, 13};
+// PNG decoding and conversion to ABGR8888 without the .rtex sidecar
+static void TextureLoad(benchmark::State& state, const std::filesystem::path& png_path) {
+    std::vector<uint32_t> texture;
+    int width{0};
+    int height{0};
     for (auto _ : state) {
-        std::vector<int> c;
-        for (auto i{0}; i < a.size(); ++i) {
-            c.push_back(a[i] + b[i]);  // Simple vector addition
+        if (!Renderer::decodePNGTexture(png_path.string(), texture, width, height)) {
+            state.SkipWithError("failed to decode the PNG");
+            return;
         }
+        benchmark::DoNotOptimize(texture.data());
+    }
+    state.counters["decoded_pixels"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * width * height, benchmark::Counter::kIsRate);
+}
+
+// transform, back-face and occlusion culling, clipping and projection of every face, rebuilt
+// each iteration by moving the model
+static void Geometry(benchmark::State& state, const std::filesystem::path& obj_path,
+                     const BenchmarkCamera& camera) {
+    auto [width, height] = BENCHMARK_RESOLUTIONS.back();
+    auto& renderer = benchmarkRenderer(obj_path, width, height, camera);
+    renderer.setRenderMode(RenderMode::RASTERIZE);
+    for (auto _ : state) {
+        renderer.setModelRotation(BENCHMARK_MODEL_ROTATION);
+        renderer.update();
     }
+    state.counters["triangles"] =
+        benchmark::Counter(static_cast<double>(state.iterations() * objFaceCount(obj_path)),
+                           benchmark::Counter::kIsRate);
+    state.counters["visible"] = static_cast<double>(renderer.triangleCount());
 }
-BENCHMARK(vectorAddition);
 
-BENCHMARK_MAIN();
\ No newline at end of file
+// binning and tile rasterization of the same triangles each iteration
+static void Raster(benchmark::State& state, const std::filesystem::path& obj_path, int width,
+                   int height, const BenchmarkCamera& camera, RenderMode mode) {
+    auto& renderer = benchmarkRenderer(obj_path, width, height, camera);
+    renderer.setRenderMode(mode);
+    renderer.update();
+    for (auto _ : state) {
+        // a new render setting makes render() rasterize again, the geometry is left as it is
+        renderer.setRenderMode(mode);
+        renderer.render(0.0);
+    }
+    state.counters["triangles"] =
+        benchmark::Counter(static_cast<double>(state.iterations() * renderer.triangleCount()),
+                           benchmark::Counter::kIsRate);
+    // pixels the triangles covered, so a model filling a tenth of the screen counts a tenth
+    state.counters["pixels"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * renderer.rasterizedPixels()),
+        benchmark::Counter::kIsRate);
+}
+
+int main(int argc, char** argv) {
+    for (const auto& obj_path : benchmarkAssets()) {
+        auto name = obj_path.stem().string();
+        benchmark::RegisterBenchmark(("ObjLoad/" + name).c_str(), ObjLoad, obj_path)
+            ->Unit(benchmark::kMillisecond);
+        auto png_path = std::filesystem::path(obj_path).replace_extension(".png");
+        if (std::filesystem::exists(png_path)) {
+            benchmark::RegisterBenchmark(("TextureLoad/" + name).c_str(), TextureLoad, png_path)
+                ->Unit(benchmark::kMillisecond);
+        }
+        for (const auto& camera : BENCHMARK_CAMERAS) {
+            auto geometry_name = "Geometry/" + name + "/" + camera.name;
+            benchmark::RegisterBenchmark(geometry_name.c_str(), Geometry, obj_path,
+                                         std::cref(camera))
+                ->Unit(benchmark::kMillisecond);
+        }
+        // grouped by renderer setup, the modes share one loaded model
+        for (auto [width, height] : BENCHMARK_RESOLUTIONS) {
+            auto resolution = std::to_string(width) + "x" + std::to_string(height);
+            for (const auto& camera : BENCHMARK_CAMERAS) {
+                for (size_t mode{0}; mode < RENDER_MODE_NAMES.size(); mode++) {
+                    auto raster_name = "Raster/" + name + "/" + RENDER_MODE_NAMES[mode] + "/" +
+                                       resolution + "/" + camera.name;
+                    benchmark::RegisterBenchmark(raster_name.c_str(), Raster, obj_path, width,
+                                                 height, std::cref(camera),
+                                                 static_cast<RenderMode>(mode))
+                        ->Unit(benchmark::kMillisecond);
+                }
+            }
+        }
+    }
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    shared_renderer.reset();
+    return 0;
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 // stl
 #include <array>
+#include <cstdint>
+#include <memory>
 #include <vector>
 // inernal
 #include <Eigen/Dense>
@@ -22,6 +24,21 @@ struct Face {
     uint32_t color;
 };
 
+// opt-in 16-bit storage of a vertex and a face, see meshQuantization.hpp
+struct QuantizedVertex {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+struct QuantizedFace {
+    int a;
+    int b;
+    int c;
+    std::array<uint16_t, 6> uvs;  // u and v of the a, b and c corner
+    uint32_t color;
+};
+
 // Stores the actual vertex values x and y
 struct Triangle {
     std::array<Eigen::Vector4f, 3> points;
@@ -36,9 +53,35 @@ struct Polygon {
     int num_of_vertices;
 };
 
-struct Mesh {
-    std::vector<Eigen::Vector3f> vertices;  // vector the mesh vertices
+// decoded geometry and texture of one model file, shared read-only between the asset cache and
+// the meshes that show it
+struct ModelData {
+    std::vector<Eigen::Vector3f> vertices;  // vector the mesh vertices, normalized
     std::vector<Face> faces;  // each face stores the indices of the vertices that make up the face
+    // compact format, replaces vertices and faces of a quantized model
+    std::vector<QuantizedVertex> quantizedVertices;
+    std::vector<QuantizedFace> quantizedFaces;
+    float positionScale{0.f};  // position = quantized * positionScale
+    Eigen::Vector2f uvMin{0.f, 0.f};  // uv = uvMin + quantized * uvScale
+    Eigen::Vector2f uvScale{0.f, 0.f};
+    std::vector<uint32_t> texture;  // ABGR8888, empty if the model has no texture
+    int textureWidth{0};
+    int textureHeight{0};
+
+    bool isQuantized() const { return !quantizedVertices.empty() || !quantizedFaces.empty(); }
+    size_t vertexCount() const {
+        return isQuantized() ? quantizedVertices.size() : vertices.size();
+    }
+    size_t faceCount() const { return isQuantized() ? quantizedFaces.size() : faces.size(); }
+    size_t byteSize() const {
+        return vertices.size() * sizeof(Eigen::Vector3f) + faces.size() * sizeof(Face) +
+               quantizedVertices.size() * sizeof(QuantizedVertex) +
+               quantizedFaces.size() * sizeof(QuantizedFace) + texture.size() * sizeof(uint32_t);
+    }
+};
+
+struct Mesh {
+    std::shared_ptr<const ModelData> data = std::make_shared<ModelData>();
     Eigen::Vector3f rotation{0, 0, 0};     // roation with x, y, z
     Eigen::Vector3f scale{1.0, 1.0, 1.0};        // scale with x, y, z
     Eigen::Vector3f translation{0, 0, 0};  // translation with x, y, z
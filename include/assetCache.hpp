@@ -0,0 +1,57 @@
+#pragma once
+// stl
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// internal
+#include "Mesh.hpp"
+
+constexpr size_t DEFAULT_ASSET_CACHE_BUDGET = size_t{256} << 20;  // bytes
+
+struct AssetCacheStats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t evictions{0};
+    size_t entries{0};
+    size_t bytes{0};  // decoded geometry and texture bytes held by the cache
+    size_t budget{0};
+};
+
+// In-process LRU cache of decoded models keyed by path. Entries are shared, so a model that is
+// still shown stays alive after its eviction. Pinned paths are never evicted, so the cache can
+// exceed its budget while the pinned models alone are larger. Safe to use from several threads
+class AssetCache {
+public:
+    explicit AssetCache(size_t budget = DEFAULT_ASSET_CACHE_BUDGET);
+
+    // counts a hit or a miss and marks the entry as most recently used
+    std::shared_ptr<const ModelData> get(const std::string& path);
+    // like get without touching the statistics or the LRU order
+    std::shared_ptr<const ModelData> peek(const std::string& path) const;
+    bool contains(const std::string& path) const;
+    void put(const std::string& path, std::shared_ptr<const ModelData> model);
+    void setPinned(std::vector<std::string> paths);
+    void setBudget(size_t budget);
+    AssetCacheStats stats() const;
+
+private:
+    struct Entry {
+        std::string path;
+        std::shared_ptr<const ModelData> model;
+        size_t bytes;
+    };
+
+    void evict();
+    bool isPinned(const std::string& path) const;
+
+private:
+    mutable std::mutex _mutex;
+    std::list<Entry> _entries;  // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> _index;
+    std::vector<std::string> _pinned;
+    AssetCacheStats _stats;
+};
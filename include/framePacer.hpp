@@ -0,0 +1,32 @@
+#pragma once
+// stl
+#include <chrono>
+
+constexpr auto FRAME_PACER_MIN_SPIN_TIME = std::chrono::microseconds(200);
+constexpr auto FRAME_PACER_MAX_SPIN_TIME = std::chrono::milliseconds(4);
+
+// Holds the frame loop to a target rate with steady_clock precision. The bulk of the wait is
+// slept and only the end is spun, as long as the sleeps of the last frames overshot plus
+// FRAME_PACER_MIN_SPIN_TIME. Frame deadlines are a fixed period apart so the rate does not drift,
+// a loop that fell behind by more than a period starts over from now instead of catching up.
+// A rate of 0 is uncapped, wait() only measures the frame time
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer(double rate = 60.0) { setTargetRate(rate); }
+    // frames per second, 0 for uncapped
+    void setTargetRate(double rate);
+    double targetRate() const { return _rate; }
+    // waits for the deadline of the next frame, seconds since the previous one (the target
+    // period on the first call)
+    double wait();
+
+private:
+    double _rate{};
+    Clock::duration _period{};
+    Clock::duration _spinTime{FRAME_PACER_MIN_SPIN_TIME};
+    Clock::time_point _deadline;
+    Clock::time_point _previousFrame;
+    bool _started{false};
+};
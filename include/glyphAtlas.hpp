@@ -0,0 +1,49 @@
+#pragma once
+// stl
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+// 3rd-Party_Libs
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+constexpr char GLYPH_ATLAS_FIRST = ' ';  // printable ASCII, other characters are drawn as '?'
+constexpr char GLYPH_ATLAS_LAST = '~';
+constexpr int GLYPH_ATLAS_WIDTH = 512;  // glyph rows of the atlas texture wrap here
+constexpr size_t TEXT_LAYOUT_CACHE_SIZE = 64;  // laid out strings kept, the fps text changes
+
+// HUD text drawn from one white texture of the font's glyphs, rasterized once when the font is
+// loaded. A string is laid out into glyph quads the first time it is drawn and the layout is
+// kept, so drawing it again is one SDL_RenderCopy per glyph with the color as color mod
+class GlyphAtlas {
+public:
+    bool build(SDL_Renderer* renderer, TTF_Font* font);
+    bool isBuilt() const { return _texture != nullptr; }
+    // the text stretched into box, like a rendered text surface copied into it
+    void draw(SDL_Renderer* renderer, std::string_view text, const SDL_Rect& box, SDL_Color color);
+
+private:
+    struct Glyph {
+        SDL_Rect source;
+        int advance;
+    };
+    struct GlyphQuad {
+        SDL_Rect source;
+        int x;  // pen position in font pixels
+    };
+    struct TextLayout {
+        std::vector<GlyphQuad> quads;
+        int width;  // font pixels
+    };
+    const TextLayout& layout(std::string_view text);
+
+private:
+    std::unique_ptr<SDL_Texture, decltype(&SDL_DestroyTexture)> _texture{nullptr,
+                                                                         SDL_DestroyTexture};
+    std::array<Glyph, GLYPH_ATLAS_LAST - GLYPH_ATLAS_FIRST + 1> _glyphs{};
+    int _height{};
+    std::unordered_map<std::string, TextLayout> _layouts;
+};
@@ -39,7 +39,7 @@ template <size_t D, typename Derived>
 
 
 // get rotation matrix follows the right-hand rule (counter-clockwise rotation)
-Eigen::Matrix3f getRotationMatrix(float alpha, float beta, float gamma) {
+inline Eigen::Matrix3f getRotationMatrix(float alpha, float beta, float gamma) {
     float cos_alpha = std::cos(alpha);
     float sin_alpha = std::sin(alpha);
     float cos_beta = std::cos(beta);
@@ -0,0 +1,11 @@
+#pragma once
+// stl
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Writes a frame of ABGR8888 pixels (the color buffer layout) as binary PPM (.ppm) or PNG (.png),
+// chosen by the extension of path. The alpha channel is dropped. PNG goes through SDL_image,
+// PPM needs no library. false if the file could not be written
+bool writeImage(const std::string& path, const std::vector<uint32_t>& pixels, int width,
+                int height);
@@ -0,0 +1,85 @@
+#pragma once
+// stl
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a job is finished when its own task and all of its children are finished
+struct Job {
+    std::function<void()> task;
+    std::shared_ptr<Job> parent;
+    std::atomic<int> unfinishedJobs{1};
+};
+
+using JobHandle = std::shared_ptr<Job>;
+
+// Persistent work-stealing scheduler shared by all stages of the pipeline.
+// every worker owns a deque, it pushes and pops its own jobs at the back (LIFO) while idle
+// workers steal from the front of the other deques (FIFO). Threads which are not workers (main
+// thread, geometry thread) submit into a shared queue and help executing jobs while they wait.
+class JobSystem {
+public:
+    explicit JobSystem(unsigned numWorkers);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // one scheduler for the whole process, hardware_concurrency - 1 workers because the waiting
+    // thread is executing jobs too
+    static JobSystem& instance();
+
+    JobHandle createJob(std::function<void()> task, const JobHandle& parent = nullptr);
+    void run(const JobHandle& job);
+    // executes pending jobs until the given job and its children are finished
+    void wait(const JobHandle& job);
+    bool isFinished(const JobHandle& job) const;
+    unsigned workerCount() const { return static_cast<unsigned>(_workers.size()); }
+
+    // splits [0, count) into chunks of grainSize, calls func(begin, end) for every chunk and
+    // waits for all of them
+    template <typename Func>
+    void parallelFor(size_t count, size_t grainSize, Func&& func) {
+        if (count == 0)
+            return;
+        grainSize = std::max<size_t>(grainSize, 1);
+        if (count <= grainSize) {
+            func(size_t{0}, count);
+            return;
+        }
+        auto root = createJob({});
+        for (size_t begin{0}; begin < count; begin += grainSize) {
+            size_t end = std::min(begin + grainSize, count);
+            run(createJob([&func, begin, end] { func(begin, end); }, root));
+        }
+        run(root);
+        wait(root);
+    }
+
+private:
+    struct JobQueue {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    void workerLoop(unsigned index);
+    JobHandle popJob(int queueIndex);
+    JobHandle findJob(int queueIndex);
+    void execute(const JobHandle& job);
+    void finish(const JobHandle& job);
+
+private:
+    // _queues[0] is shared by the non-worker threads, _queues[i + 1] belongs to worker i
+    std::vector<std::unique_ptr<JobQueue>> _queues;
+    std::vector<std::thread> _workers;
+    std::atomic<int> _queuedJobs{0};
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeUp;
+    bool _stop{false};
+};
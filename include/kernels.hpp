@@ -0,0 +1,40 @@
+#pragma once
+// stl
+#include <cstddef>
+#include <cstdint>
+
+// triangle values which are constant along a span, taken from the screen space vertices
+struct SpanTriangle {
+    float ax, ay, bx, by, cx, cy;   // screen positions
+    float inv_aw, inv_bw, inv_cw;   // 1 / w
+    float au_w, av_w, bu_w, bv_w, cu_w, cv_w;  // texture coordinates divided by w
+};
+
+// Hot loops of the pipeline. src/kernels.cpp is compiled once per instruction set (SSE2, AVX2,
+// AVX-512) into its own namespace, kernels() returns the variant for the CPU the process runs on.
+// the signatures only use plain types so all variants share the same ABI
+struct Kernels {
+    const char* name;
+    // view space xyz of count vertices (packed xyz floats) with a column-major 4x4 matrix, w = 1
+    void (*transformVertices)(const float* matrix, const float* vertices, float* out, size_t count);
+    // the same for packed xyz int16 vertices, dequantized as value * scale
+    void (*transformQuantizedVertices)(const float* matrix, const int16_t* vertices, float scale,
+                                       float* out, size_t count);
+    void (*fillColor)(uint32_t* colors, size_t count, uint32_t color);
+    void (*fillDepth)(float* depths, size_t count, float depth);
+    // depth tested pixels [x_begin, x_end) of row y with a solid color
+    void (*shadeSpan)(const SpanTriangle& tri, int y, int x_begin, int x_end, uint32_t color,
+                      uint32_t* color_row, float* depth_row);
+    // depth tested pixels [x_begin, x_end) of row y with perspective correct texture lookups
+    void (*textureSpan)(const SpanTriangle& tri, int y, int x_begin, int x_end,
+                        const uint32_t* texture, int texture_width, int texture_height,
+                        uint32_t* color_row, float* depth_row);
+    // ABGR8888 rows to I420 (BT.601 limited range): the luma of both rows and one chroma row of
+    // the 2x2 block averages, (width + 1) / 2 values of u and v. the last row of an odd height
+    // passes the same row twice
+    void (*convertToI420)(const uint32_t* row0, const uint32_t* row1, int width, uint8_t* y0,
+                          uint8_t* y1, uint8_t* u, uint8_t* v);
+};
+
+// selected once from instrset_detect() on first use
+const Kernels& kernels();
@@ -0,0 +1,43 @@
+#pragma once
+// stl
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file, the contents are paged in by the OS on first access
+// so nothing is copied into user space buffers
+class MappedFile {
+public:
+    // read-ahead hint for the OS
+    enum class Access { SEQUENTIAL, RANDOM };
+
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path, Access access = Access::SEQUENTIAL);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // false if the file could not be opened or mapped, an empty file is open with size 0
+    bool isOpen() const { return _open; }
+    const char* data() const { return _data; }
+    size_t size() const { return _size; }
+    std::string_view view() const { return {_data, _size}; }
+    // drops the pages of [offset, offset + size) from the process, they are read from the file
+    // again on the next access
+    void release(size_t offset, size_t size) const;
+
+private:
+    void close();
+
+private:
+    const char* _data{nullptr};
+    size_t _size{0};
+    bool _open{false};
+#ifdef _WIN32
+    void* _fileHandle{nullptr};
+    void* _mappingHandle{nullptr};
+#endif
+};
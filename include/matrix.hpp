@@ -1,70 +1,77 @@
 #pragma once
 // Stl
-#include <vector>
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
 #include <iostream>
-#include <algorithm>
-
-template<typename T, size_t M, size_t N>
+#include <tuple>
+#include <type_traits>
+// Internal
+#include "vector.hpp"
+// 3rd-Party_Libs
+#include "version2/vectorclass.h"
+
+// Fixed size M x N matrix, everything is constexpr and the dimensions are template parameters only.
+// The values are stored column by column like Eigen, so for float 4x4 a column is one Vec4f and
+// the products below switch to VCL when they are not evaluated at compile time.
+template <typename T, size_t M, size_t N>
 class Matrix {
 public:
-    Matrix() : _rows(M), _cols(N) {
+    constexpr Matrix() {
         if constexpr (M == N) {
             setEye();
         }
     }
 
-    Matrix(const std::initializer_list<T>& list) : _rows(M), _cols(N) {
-        if (list.size() != M * N) {
-            throw std::invalid_argument("Initializer list size does not match matrix dimensions.");
+    // values are given row by row
+    template <typename... Args>
+        requires(sizeof...(Args) == M * N && (std::convertible_to<Args, T> && ...))
+    constexpr Matrix(Args... values) {
+        const std::array<T, M * N> row_major{static_cast<T>(values)...};
+        for (size_t i = 0; i < M; i++) {
+            for (size_t j = 0; j < N; j++) {
+                (*this)(i, j) = row_major[i * N + j];
+            }
         }
-        std::copy(std::begin(list), std::end(list), std::begin(_data));
     }
-    
-    Matrix(const Matrix& other) = default;
-    Matrix& operator=(const Matrix& other) = default;
-    Matrix(Matrix&& other) noexcept = default;
-    Matrix& operator=(Matrix&& other) noexcept = default;
 
-    T operator()(size_t row, size_t col) const { return _data[row * _cols + col]; }
-    T& operator()(size_t row, size_t col) { return _data[row * _cols + col]; }
-    size_t size() const { return _rows * _cols; }
-    T cols() const { return _cols; }
-    T rows() const { return _rows; }
+    constexpr Matrix(const Matrix& other) = default;
+    constexpr Matrix& operator=(const Matrix& other) = default;
+    constexpr Matrix(Matrix&& other) noexcept = default;
+    constexpr Matrix& operator=(Matrix&& other) noexcept = default;
 
-    Matrix<T, M, N> operator+(const Matrix<T, M, N>& other) const {
-        Matrix result;
-        std::transform(_data.begin(), _data.end(), other._data.begin(), result._data.begin(),
-                       std::plus<>());
-        return result;
-    }
+    constexpr T operator()(size_t row, size_t col) const { return _data[col * M + row]; }
+    constexpr T& operator()(size_t row, size_t col) { return _data[col * M + row]; }
+    static constexpr size_t size() { return M * N; }
+    static constexpr size_t cols() { return N; }
+    static constexpr size_t rows() { return M; }
+    constexpr const T* data() const { return _data.data(); }
+    constexpr T* data() { return _data.data(); }
 
-    Matrix<T, M, N> operator-(const Matrix<T, M, N>& other) const {
-        Matrix<T, M, N> result;
-        std::transform(_data.begin(), _data.end(), other._data.begin(), result._data.begin(),
-                       std::minus<>());
+    constexpr Matrix operator+(const Matrix& other) const {
+        Matrix result;
+        for (size_t i = 0; i < M * N; i++) {
+            result._data[i] = _data[i] + other._data[i];
+        }
         return result;
     }
 
-    Matrix<T, M, N> operator*(const Matrix<T, M, N>& other) const {
-        Matrix<T, M, N> result;
-        for (size_t i = 0; i < _rows; i++) {
-            for (size_t j = 0; j < _cols; j++) {
-                result(i, j) = T{};
-                for (size_t k = 0; k < _cols; k++) {
-                    result(i, j) += (*this)(i, k) * other(k, j);
-                }
-            }
+    constexpr Matrix operator-(const Matrix& other) const {
+        Matrix result;
+        for (size_t i = 0; i < M * N; i++) {
+            result._data[i] = _data[i] - other._data[i];
         }
         return result;
     }
 
     friend std::ostream& operator<<(std::ostream& os, const Matrix& m) {
-        for (size_t i = 0; i < m._rows; i++) {
+        for (size_t i = 0; i < M; i++) {
             os << "[ ";
-            for (size_t j = 0; j < m._cols; j++) {
+            for (size_t j = 0; j < N; j++) {
                 os << m(i, j);
-                if (j + 1 < m._cols)
+                if (j + 1 < N)
                     os << ", ";
             }
             os << " ]\n";
@@ -72,120 +79,112 @@ public:
         return os;
     }
 
-    Matrix<int, 4, 1> toInt() const {
-        if (_rows * _cols == 4)
-            return {static_cast<int>(_data[0]), static_cast<int>(_data[1]),
-                    static_cast<int>(_data[2]), static_cast<int>(_data[3])}; 
-    }
-
-    Matrix<float, 4, 1> toFloat() const {
-        if (_rows * _cols == 4)
-            return {static_cast<float>(_data[0]), static_cast<float>(_data[1]),
-                    static_cast<float>(_data[2]), static_cast<float>(_data[3])};
-    }
-
-    void setEye() {
-        std::fill(std::begin(_data), std::end(_data), 0);
-        for (size_t i = 0; i < std::min(_rows, _cols); i++) {
-            _data[i * _cols + i] = T{1};
+    template <typename U>
+    constexpr Matrix<U, M, N> cast() const {
+        Matrix<U, M, N> result;
+        for (size_t i = 0; i < M; i++) {
+            for (size_t j = 0; j < N; j++) {
+                result(i, j) = static_cast<U>((*this)(i, j));
+            }
         }
+        return result;
     }
+    constexpr Matrix<int, M, N> toInt() const { return cast<int>(); }
+    constexpr Matrix<float, M, N> toFloat() const { return cast<float>(); }
 
-    void setScale(const T& sx, const T& sy, const T& sz) {
-        if constexpr (M >= 4 && N >= 4) {
-            Matrix<T, 4, 4> S;
-            S(0, 0) = sx;
-            S(1, 1) = sy;
-            S(2, 2) = sz;
-            *this = S * *this;  // order of multiplication matters
-        } else {
-            throw std::invalid_argument("Matrix must be at least 4x4 to set scale.");
-        }
-    }
-    void setTranslation(const T& tx, const T& ty, const T& tz) {
-        if constexpr (M >= 4 && N >= 4) {
-            Matrix<T, 4, 4> Trans;
-            Trans(0, 3) = tx;
-            Trans(1, 3) = ty;
-            Trans(2, 3) = tz;
-            *this = Trans * *this;  // order of multiplication matters
-        } else {
-            throw std::invalid_argument("Matrix must be at least 4x4 to set translation.");
-        }
-    }
-    void setRotation(const T& alpha, const T& beta, const T& gamma) {
-        if constexpr (M >= 4 && N >= 4) {
-            Matrix<T, 4, 4> R = getRotationMatrix(alpha, beta, gamma);
-            *this = *this * R;  // order of multiplication matters
-        } else {
-            throw std::invalid_argument("Matrix must be at least 4x4 to set rotation.");
+    constexpr void setEye() {
+        _data.fill(T{});
+        for (size_t i = 0; i < std::min(M, N); i++) {
+            (*this)(i, i) = T{1};
         }
     }
 
-    Matrix<T, M, N> getRotationMatrix(T alpha, T beta, T gamma) const {
-        // rotation matrices follows the right-hand rule (counter-clockwise rotation)
-        auto cos_alpha = cos(alpha);
-        auto sin_alpha = sin(alpha);
-        auto cos_beta = cos(beta);
-        auto sin_beta = sin(beta);
-        auto cos_gamma = cos(gamma);
-        auto sin_gamma = sin(gamma);
-        Matrix<T, 4, 4> Rx{1, 0, 0, 0, 0, cos_alpha, -sin_alpha, 0, 0, sin_alpha, cos_alpha, 0, 0, 0, 0, 1};
-        Matrix<T, 4, 4> Ry{cos_beta, 0, sin_beta, 0, 0, 1, 0, 0, -sin_beta, 0, cos_beta, 0, 0, 0, 0, 1};
-        Matrix<T, 4, 4> Rz{cos_gamma, -sin_gamma, 0, 0, sin_gamma, cos_gamma, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
-        return Rz * Ry * Rx;  // order of multiplication Doesn't matter
-    }
-
-    T x() const { return _data[0]; }
-    T y() const { return _data[1]; }
-    T z() const { 
-        if (_rows * _cols < 3) {
-            throw std::invalid_argument("Matrix does not have a z component.");
-        }
-        return _data[2]; 
+    constexpr void setScale(const T& sx, const T& sy, const T& sz)
+        requires(M == 4 && N == 4)
+    {
+        Matrix S;
+        S(0, 0) = sx;
+        S(1, 1) = sy;
+        S(2, 2) = sz;
+        *this = S * *this;  // order of multiplication matters
     }
-    T w() const { 
-        if (_rows * _cols < 4) {
-            throw std::invalid_argument("Matrix does not have a w component.");
-        }
-        return _data[3]; 
+
+    constexpr void setTranslation(const T& tx, const T& ty, const T& tz)
+        requires(M == 4 && N == 4)
+    {
+        Matrix Trans;
+        Trans(0, 3) = tx;
+        Trans(1, 3) = ty;
+        Trans(2, 3) = tz;
+        *this = Trans * *this;  // order of multiplication matters
     }
 
-    T& x() { return _data[0]; }
-    T& y() { return _data[1]; }
-    T& z() { 
-        if (_rows * _cols < 3) {
-            throw std::invalid_argument("Matrix does not have a z component.");
-        }
-        return _data[2]; 
+    void setRotation(const T& alpha, const T& beta, const T& gamma)
+        requires(M == 4 && N == 4)
+    {
+        *this = *this * getRotationMatrix(alpha, beta, gamma);  // order of multiplication matters
     }
-    T& w() { 
-        if (_rows * _cols < 4) {
-            throw std::invalid_argument("Matrix does not have a w component.");
-        }
-        return _data[3]; 
+
+    // rotation matrices follows the right-hand rule (counter-clockwise rotation)
+    // not constexpr, std::cos and std::sin are not constexpr before C++26
+    static Matrix getRotationMatrix(T alpha, T beta, T gamma)
+        requires(M == 4 && N == 4)
+    {
+        auto cos_alpha = std::cos(alpha);
+        auto sin_alpha = std::sin(alpha);
+        auto cos_beta = std::cos(beta);
+        auto sin_beta = std::sin(beta);
+        auto cos_gamma = std::cos(gamma);
+        auto sin_gamma = std::sin(gamma);
+        Matrix Rx{1, 0, 0, 0, 0, cos_alpha, -sin_alpha, 0, 0, sin_alpha, cos_alpha, 0, 0, 0, 0, 1};
+        Matrix Ry{cos_beta, 0, sin_beta, 0, 0, 1, 0, 0, -sin_beta, 0, cos_beta, 0, 0, 0, 0, 1};
+        Matrix Rz{cos_gamma, -sin_gamma, 0, 0, sin_gamma, cos_gamma, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+        return Rz * Ry * Rx;  // Z * Y * X (yaw-pitch-roll)
     }
 
-    std::tuple<T, T, T, T> get4() {
-        if (_rows * _cols == 4)
-            return {_data[0], _data[1], _data[2], _data[3]};
+    // component access for column and row vectors
+    constexpr T x() const requires(M == 1 || N == 1) { return _data[0]; }
+    constexpr T y() const requires((M == 1 || N == 1) && M * N >= 2) { return _data[1]; }
+    constexpr T z() const requires((M == 1 || N == 1) && M * N >= 3) { return _data[2]; }
+    constexpr T w() const requires((M == 1 || N == 1) && M * N >= 4) { return _data[3]; }
+
+    constexpr T& x() requires(M == 1 || N == 1) { return _data[0]; }
+    constexpr T& y() requires((M == 1 || N == 1) && M * N >= 2) { return _data[1]; }
+    constexpr T& z() requires((M == 1 || N == 1) && M * N >= 3) { return _data[2]; }
+    constexpr T& w() requires((M == 1 || N == 1) && M * N >= 4) { return _data[3]; }
+
+    constexpr std::tuple<T, T, T, T> get4() const requires(M * N == 4) {
+        return {_data[0], _data[1], _data[2], _data[3]};
     }
-    std::tuple<T, T, T> get3() { 
-        if (_rows * _cols == 3)
-            return {_data[0], _data[1], _data[2]};
+    constexpr std::tuple<T, T, T> get3() const requires(M * N == 3) {
+        return {_data[0], _data[1], _data[2]};
     }
 
 private:
-    template <typename U, size_t m, size_t K, size_t n>
-    friend Matrix<U, m, n> operator*(const Matrix<U, m, K>& a, const Matrix<U, K, n>& b);
-    size_t _rows;
-    size_t _cols;
-    std::array<T, M * N> _data;
+    std::array<T, M * N> _data{};
 };
 
 template <typename U, size_t m, size_t K, size_t n>
-Matrix<U, m, n> operator*(const Matrix<U, m, K>& a, const Matrix<U, K, n>& b) {
+constexpr Matrix<U, m, n> operator*(const Matrix<U, m, K>& a, const Matrix<U, K, n>& b) {
     Matrix<U, m, n> result;
+    if constexpr (std::is_same_v<U, float> && m == 4 && K == 4) {
+        if !consteval {
+            // column j of the result is the sum of the columns of a weighted by column j of b
+            const Vec4f a0 = Vec4f().load(a.data());
+            const Vec4f a1 = Vec4f().load(a.data() + 4);
+            const Vec4f a2 = Vec4f().load(a.data() + 8);
+            const Vec4f a3 = Vec4f().load(a.data() + 12);
+            for (size_t j = 0; j < n; j++) {
+                const float* b_col = b.data() + 4 * j;
+                Vec4f col = a0 * b_col[0];
+                col = mul_add(a1, Vec4f(b_col[1]), col);
+                col = mul_add(a2, Vec4f(b_col[2]), col);
+                col = mul_add(a3, Vec4f(b_col[3]), col);
+                col.store(result.data() + 4 * j);
+            }
+            return result;
+        }
+    }
     for (size_t i = 0; i < m; i++) {
         for (size_t j = 0; j < n; j++) {
             result(i, j) = U{};
@@ -195,4 +194,26 @@ Matrix<U, m, n> operator*(const Matrix<U, m, K>& a, const Matrix<U, K, n>& b) {
         }
     }
     return result;
-}
\ No newline at end of file
+}
+
+template <typename U>
+constexpr vector<U, 4> operator*(const Matrix<U, 4, 4>& a, const vector<U, 4>& v) {
+    if constexpr (std::is_same_v<U, float>) {
+        if !consteval {
+            Vec4f result = Vec4f().load(a.data()) * v.x();
+            result = mul_add(Vec4f().load(a.data() + 4), Vec4f(v.y()), result);
+            result = mul_add(Vec4f().load(a.data() + 8), Vec4f(v.z()), result);
+            result = mul_add(Vec4f().load(a.data() + 12), Vec4f(v.w()), result);
+            vector<U, 4> out;
+            result.store(out.data());
+            return out;
+        }
+    }
+    vector<U, 4> out;
+    for (size_t i = 0; i < 4; i++) {
+        out[i] = a(i, 0) * v.x() + a(i, 1) * v.y() + a(i, 2) * v.z() + a(i, 3) * v.w();
+    }
+    return out;
+}
+
+using mat4f_t = Matrix<float, 4, 4>;
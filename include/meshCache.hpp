@@ -0,0 +1,42 @@
+#pragma once
+// stl
+#include <cstdint>
+#include <string>
+#include <vector>
+// internal
+#include "Mesh.hpp"
+
+constexpr uint32_t MESH_CACHE_VERSION = 2;  // bump whenever the .rmesh layout changes
+// header flags, a sidecar is only used by loads asking for the same options
+constexpr uint32_t MESH_CACHE_VERTEX_CACHE_OPTIMIZED = 1u << 0;  // meshOptimizer.hpp order
+
+// Binary sidecar (<model>.rmesh next to <model>.obj) holding the normalized positions, the face
+// indices and the per corner texture coordinates, so later loads skip parsing and normalization.
+// The file starts with a versioned header that records the size and modification time of the
+// source OBJ and an FNV-1a hash of the payload; a cache that is stale, corrupt or written by an
+// other version is ignored. Values are stored in native byte order.
+std::string meshCachePath(const std::string& obj_path);
+
+// shared by the sidecar formats (.rmesh, .rtex): the payload hash, the size and modification
+// time of the source file, and a write through a uniquely named temporary file that is renamed
+// into place, so a concurrent reader never maps a partial file
+uint64_t fnv1aHash(const void* data, size_t size);
+bool sourceFileStamp(const std::string& source_path, uint64_t& size, int64_t& time);
+bool writeSidecarFile(const std::string& path, const void* header, size_t header_size,
+                      const void* payload, size_t payload_size);
+
+// payload layout shared by the .rmesh and .rstream files: num_vertices * 3 float positions,
+// num_faces * 3 int32 vertex indices and num_faces * 6 float texture coordinates (a, b, c corner)
+size_t meshPayloadSize(size_t num_vertices, size_t num_faces);
+void packMeshPayload(const std::vector<Eigen::Vector3f>& vertices, const std::vector<Face>& faces,
+                     std::vector<char>& payload);
+void unpackMeshPayload(const char* payload, size_t num_vertices, size_t num_faces,
+                       std::vector<Eigen::Vector3f>& vertices, std::vector<Face>& faces);
+
+// maps the sidecar of obj_path and copies it into the mesh arrays, false if there is no valid one
+bool loadMeshCache(const std::string& obj_path, uint32_t flags,
+                   std::vector<Eigen::Vector3f>& vertices, std::vector<Face>& faces);
+
+// writes the sidecar of obj_path through a temporary file, false if it could not be written
+bool saveMeshCache(const std::string& obj_path, uint32_t flags,
+                   const std::vector<Eigen::Vector3f>& vertices, const std::vector<Face>& faces);
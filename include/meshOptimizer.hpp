@@ -0,0 +1,23 @@
+#pragma once
+// stl
+#include <vector>
+// internal
+#include "Mesh.hpp"
+
+constexpr size_t ACMR_CACHE_SIZE = 16;  // FIFO entries of the simulated post-transform cache
+constexpr int FORSYTH_CACHE_SIZE = 32;  // LRU entries modelled by the face reordering
+
+// Load-time locality optimization of indexed meshes. Faces are reordered with Tom Forsyth's
+// linear-speed vertex cache optimization, so consecutive faces share vertices, and the vertices
+// are renumbered in first-use order, so the index-based vertex fetch of the geometry stage walks
+// memory front to back
+
+// average cache miss ratio: transformed vertices per face with a FIFO cache of cache_size
+// entries, 3 is the worst case and about 0.5 the best possible for regular meshes
+float averageCacheMissRatio(const std::vector<Face>& faces, size_t num_vertices,
+                            size_t cache_size = ACMR_CACHE_SIZE);
+
+void optimizeVertexCache(std::vector<Face>& faces, size_t num_vertices);
+
+// vertices no face uses keep their relative order behind the used ones
+void reorderVerticesByFirstUse(std::vector<Eigen::Vector3f>& vertices, std::vector<Face>& faces);
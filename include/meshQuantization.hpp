@@ -0,0 +1,30 @@
+#pragma once
+// stl
+#include <cstdint>
+// internal
+#include "Mesh.hpp"
+
+// Opt-in compact format of a loaded model. Positions become signed 16-bit fixed point scaled by
+// ModelData::positionScale (for a normalized model one step is 1/65534 of the unit cube) and
+// are dequantized by the transform kernel. Texture coordinates become 16-bit steps between the
+// uv bounds of the model and the faces are dequantized one at a time by the geometry stage.
+// Vertex memory is halved, faces shrink from 52 to 28 bytes
+
+// replaces vertices and faces of the model with quantizedVertices and quantizedFaces
+void quantizeModel(ModelData& model);
+
+inline Face dequantizeFace(const ModelData& model, const QuantizedFace& quantized) {
+    auto uv = [&](int corner) {
+        return Eigen::Vector2f(model.uvMin.x() + quantized.uvs[2 * corner] * model.uvScale.x(),
+                               model.uvMin.y() + quantized.uvs[2 * corner + 1] * model.uvScale.y());
+    };
+    Face face{};
+    face.a_uv = uv(0);
+    face.b_uv = uv(1);
+    face.c_uv = uv(2);
+    face.a = quantized.a;
+    face.b = quantized.b;
+    face.c = quantized.c;
+    face.color = quantized.color;
+    return face;
+}
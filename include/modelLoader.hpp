@@ -0,0 +1,47 @@
+#pragma once
+// stl
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+// internal
+#include "Mesh.hpp"
+#include "assetCache.hpp"
+
+// Loads models on one background thread so the frame loop keeps rendering the current model.
+// Finished models go into the asset cache, the caller picks them up from there
+class ModelLoader {
+public:
+    using LoadFunc = std::function<void(const std::string& path, ModelData& model)>;
+
+    explicit ModelLoader(LoadFunc load);
+    ~ModelLoader();
+
+    ModelLoader(const ModelLoader&) = delete;
+    ModelLoader& operator=(const ModelLoader&) = delete;
+
+    // replaces the pending requests with paths, loaded in order unless they are cached or loading
+    // already. The paths stay pinned in the cache until the next request
+    void request(const std::vector<std::string>& paths);
+    // blocks until every requested path is loaded, or dropped by a newer request
+    void waitUntilIdle();
+    AssetCache& cache() { return _cache; }
+    const AssetCache& cache() const { return _cache; }
+
+private:
+    void loaderLoop();
+
+private:
+    LoadFunc _load;
+    AssetCache _cache;
+    std::mutex _mutex;
+    std::condition_variable _wakeUp;
+    std::condition_variable _idle;  // notified whenever the queue runs empty
+    std::deque<std::string> _queue;
+    std::string _loading;  // path in progress on the loader thread
+    bool _stop{false};
+    std::thread _thread;
+};
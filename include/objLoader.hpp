@@ -0,0 +1,22 @@
+#pragma once
+// stl
+#include <string>
+#include <string_view>
+#include <vector>
+// internal
+#include "Mesh.hpp"
+
+constexpr size_t OBJ_CHUNK_SIZE = size_t{1} << 20;  // bytes of OBJ text per parse job
+
+// Wavefront OBJ parsing of the v, vt and f records, the text is tokenized in place with
+// std::from_chars (locale independent, no line length limit). Faces take the first three
+// corners in v, v/vt, v//vn or v/vt/vn form, negative indices count back from the last record.
+// malformed lines are reported on std::cerr and skipped.
+// line aligned chunks of the text are parsed in parallel on the job system and merged in file
+// order with prefix sums over the per-chunk record counts
+void parseObj(std::string_view text, std::vector<Eigen::Vector3f>& vertices,
+              std::vector<Face>& faces);
+
+// memory maps the file and parses it, false if the file can not be opened
+bool loadObj(const std::string& path, std::vector<Eigen::Vector3f>& vertices,
+             std::vector<Face>& faces);
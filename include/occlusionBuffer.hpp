@@ -0,0 +1,32 @@
+#pragma once
+// stl
+#include <vector>
+// internal
+#include "Mesh.hpp"
+
+constexpr int OCCLUSION_BUFFER_WIDTH = 256;
+constexpr int OCCLUSION_BUFFER_HEIGHT = 128;
+constexpr int MAX_NUM_OCCLUDERS = 512;
+constexpr float MIN_OCCLUDER_AREA = 8.f;  // in occlusion buffer pixels
+
+// Low resolution depth buffer used to reject triangles that are hidden behind big occluders
+// before they reach the rasterizer.
+// depth values are the view space depth (w component after projection), smaller is closer
+class OcclusionBuffer {
+public:
+    OcclusionBuffer();
+
+    void setScreenSize(int width, int height);
+    void clear();
+    // conservative depth-only rasterization, only pixels fully covered by the triangle are written
+    void rasterizeOccluder(const Triangle& tri);
+    // true if every pixel touched by the triangle has an occluder closer than the triangle
+    bool isOccluded(const Triangle& tri) const;
+    // triangle area in occlusion buffer pixels
+    float area(const Triangle& tri) const;
+
+private:
+    float _scaleX{1.f};
+    float _scaleY{1.f};
+    std::vector<float> _depth;
+};
@@ -0,0 +1,17 @@
+#pragma once
+// Tracy instrumentation, compiled in with ENABLE_PROFILING (TRACY_ENABLE) and to nothing otherwise
+#ifdef TRACY_ENABLE
+// 3rd-Party_Libs
+#include <tracy/Tracy.hpp>
+
+// named zone until the end of the enclosing scope
+#define PROFILE_ZONE(name) ZoneScopedN(name)
+// value of a plot, one point per call
+#define PROFILE_PLOT(name, value) TracyPlot(name, static_cast<int64_t>(value))
+// name of the calling thread in the profiler, the string is copied
+#define PROFILE_THREAD_NAME(name) tracy::SetThreadName(name)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_PLOT(name, value)
+#define PROFILE_THREAD_NAME(name)
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+// stl
+#include <filesystem>
+#include <string>
+#include <vector>
+// internal
+#include "renderer.hpp"
+
+constexpr const char* TURNTABLE_CAMERA_PATH = "turntable";  // one model turn about y per job
+
+// camera pose of one keyframe of a camera path file
+struct CameraKey {
+    Vector3f position;
+    float yaw;
+    float pitch;
+};
+
+// one line of a job file
+struct RenderJob {
+    std::string modelPath;
+    std::string cameraPath;  // TURNTABLE_CAMERA_PATH or a file of "x y z yaw pitch" keyframes
+    int width;
+    int height;
+    RenderMode mode;
+    int frames;
+};
+
+struct RenderJobResult {
+    bool succeeded{false};
+    double loadMs{0.0};  // offscreen setup and model load
+    double renderMs{0.0};  // update() and render() of all frames
+    double writeMs{0.0};  // image files
+    double minFrameMs{0.0};
+    double maxFrameMs{0.0};
+};
+
+// Batch mode of the executable. Every job renders its model offscreen along its camera path and
+// writes the frames to <output_dir>/<job>_<model>/<model>_<frame>.<format>. Jobs run
+// concurrently, one Renderer per job thread, and the renderers share the process JobSystem
+class RENDERER_API RenderFarm {
+public:
+    // one job per line: <model> <width>x<height> <render mode 1-6> <frames> <camera path>,
+    // relative paths are relative to the job file, empty lines and lines starting with # are
+    // skipped. false on the first malformed line
+    bool loadJobFile(const std::string& path);
+    // renders all jobs with up to threads jobs at a time (hardware concurrency if 0), false if
+    // a job failed
+    bool run(const std::filesystem::path& output_dir, const std::string& image_format,
+             unsigned threads = 0);
+    // one CSV line of timings per job
+    bool writeReport(const std::filesystem::path& path) const;
+
+    const std::vector<RenderJob>& jobs() const { return _jobs; }
+    const std::vector<RenderJobResult>& results() const { return _results; }
+
+private:
+    RenderJobResult renderJob(size_t index, const std::filesystem::path& output_dir,
+                              const std::string& image_format) const;
+
+private:
+    std::vector<RenderJob> _jobs;
+    std::vector<RenderJobResult> _results;
+};
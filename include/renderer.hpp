@@ -1,14 +1,26 @@
 #pragma once
 // stl
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <thread>
 #include <vector>
 #include <string>
 #include <execution>
 // internal
 #include "Mesh.hpp"
+#include "framePacer.hpp"
+#include "glyphAtlas.hpp"
+#include "jobSystem.hpp"
+#include "kernels.hpp"
+#include "modelLoader.hpp"
+#include "occlusionBuffer.hpp"
+#include "resolutionScaler.hpp"
+#include "streamingMesh.hpp"
 #include "timer.hpp"
+#include "transform.hpp"
+#include "videoSink.hpp"
 #include "helperFuncs.hpp"
 // 3rd-Party_Libs
 #include <SDL2/SDL.h>
@@ -45,6 +57,20 @@ enum class RenderMode {
     TEXTURE_WIREFRAME
 };
 
+constexpr size_t FACE_CHUNK_SIZE = 1024;  // faces per geometry job
+constexpr size_t VERTEX_CHUNK_SIZE = 4096;  // vertices per transform job
+constexpr int TILE_HEIGHT = 32;  // rows of the color buffer per rasterization job
+
+// screen rectangle [minX, maxX) x [minY, maxY) owned by one rasterization job
+struct Tile {
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+
+    bool contains(int x, int y) const { return x >= minX && x < maxX && y >= minY && y < maxY; }
+};
+
 enum FRUSTUMPLANES {
     LEFT_PLANE = 0,
     RIGHT_PLANE,
@@ -71,52 +97,140 @@ enum FRUSTUMPLANES {
 class RENDERER_API Renderer {
 public:
     bool initializeWindow(bool fullscreen = false);
+    // renders into a width x height color buffer only, without SDL video, window or font. update()
+    // steps a fixed 1 / frame rate limit per frame and render() does not present anything
+    bool initializeOffscreen(int width, int height);
     bool setupWindow(const std::string& obj_file_path);
     bool getWindowState();
     void processInput();
     void update();
     void render(double timer_value);
     void destroyWindow();
+    // ABGR8888 pixels of the last rendered frame, row by row. a window with zero-copy
+    // presentation rasterizes into its texture instead, unless a video output is set
+    const std::vector<uint32_t>& colorBuffer() const { return _colorBuffer; }
+    // render resolution, the size of the color buffer
+    int width() const { return _renderWidth; }
+    int height() const { return _renderHeight; }
+    // triangles left by the geometry stage after culling and clipping, the ones render() draws
+    size_t triangleCount() const { return _lastTrianglesToRender.size(); }
+    // pixels the last rasterized frame depth tested or drew, the grid and clears not included
+    uint64_t rasterizedPixels() const { return _lastRasterizedPixels; }
+    // writes the color buffer as .ppm or .png (imageWriter.hpp)
+    bool saveFrame(const std::string& path) const;
+    void setRenderMode(RenderMode mode);
+    void setRotateModel(bool rotate);
+    // camera and model pose of the next update(), for scripted camera paths
+    void setCamera(const Vector3f& position, float yaw, float pitch);
+    void setModelRotation(const Vector3f& rotation);
+    // overlap the geometry stage of the next frame with the rasterization of the current one
+    void setPipelined(bool pipelined);
+    // memory budget of the decoded models kept for revisiting, DEFAULT_ASSET_CACHE_BUDGET if unset
+    void setAssetCacheBudget(size_t bytes);
+    AssetCacheStats assetCacheStats() const;
+    // resident chunk budget of a .rstream mesh, DEFAULT_STREAMING_BUDGET if unset
+    void setStreamingBudget(size_t bytes);
+    // reorder loaded OBJ meshes for vertex reuse (meshOptimizer.hpp), set before setupWindow
+    void setOptimizeMeshes(bool optimize);
+    // keep loaded and streamed meshes in the 16-bit format (meshQuantization.hpp), set before
+    // setupWindow
+    void setQuantizeMeshes(bool quantize);
+    // lower the render resolution in steps while frames take longer than _frameTargetTime and
+    // raise it again with headroom, the frames are scaled up to the window (resolutionScaler.hpp).
+    // set before setupWindow, ignored offscreen and with a video output
+    void setDynamicResolution(bool enable);
+    // frames per second the window loop is held to (default 60), 0 renders as fast as possible
+    void setFrameRateLimit(double fps);
+    // streams every rendered frame as Y4M to path, "-" is stdout (videoSink.hpp), set before
+    // setupWindow. with a window, frames the sink can not take in time are dropped so the frame
+    // loop never waits, offscreen every frame is written
+    void setVideoOutput(const std::string& path);
+    // rolling per-stage frame times (timer.hpp)
+    const StageTimer& stageTimings() const { return _stageTimer; }
+    // destroyWindow() writes the stage timings to path, csv or json by extension, "-" is stdout
+    void setStageTimingsOutput(const std::string& path);
+    // converts an OBJ (normalized like a loaded model) into a .rstream file of spatial chunks
+    static bool convertToStreamFile(const std::string& obj_file_path,
+                                    const std::string& stream_file_path);
+    // decodes a PNG into ABGR8888 pixels, without the .rtex sidecar
+    static bool decodePNGTexture(const std::string& png_path, std::vector<uint32_t>& texture,
+                                 int& width, int& height);
 
 private:
     void drawText(std::string_view text, const Vector2i& dims, const Vector2i& pos,
                   bool enabledMode);
-    void drawGrid();
-    void drawPixel(int x, int y, uint32_t color);
-    void drawTrianglePixel(int x, int y, uint32_t color, const Vector4f& point_a,
-                           const Vector4f& point_b, const Vector4f& point_c);
-    void drawTexel(const Vector2i& point, const std::vector<uint32_t>& texture, const Vector4f& a,
-                   const Vector4f& b, const Vector4f& c, const Vector2f& uv0, const Vector2f& uv1,
-                   const Vector2f& uv2);
-    Vector3f barycentric_weights(const Vector2f& a, const Vector2f& b, const Vector2f& c,
-                                 const Vector2f& p);
-    void drawRect(int x, int y, int width, int height, uint32_t color);
-    void drawLine(int x0, int y0, int x1, int y1, uint32_t color);
-    void drawTriangle(const Triangle& tri, uint32_t color);
-    void rasterizeTexturedTriangle(const Triangle& tri, const std::vector<uint32_t>& textureBuffer);
-    void rasterizeTriangle1(const Triangle& tri, uint32_t color);
-    void rasterizeTriangle2(const Triangle& tri, uint32_t color);
-    void rasterizeFlatBottomTriangle(const Vector2i& p0, const Vector2i& p1, const Vector2i& p2,
-                                     uint32_t color);
-    void rasterizeFlatTopTriangle(const Vector2i& p0, const Vector2i& p1, const Vector2i& p2,
-                                  uint32_t color);
+    void drawGrid(const Tile& tile);
+    void drawPixel(const Tile& tile, int x, int y, uint32_t color);
+    // depth tested spans through the dispatched kernels, clipped to the tile
+    void drawSpan(const Tile& tile, const SpanTriangle& span, int y, int x_start, int x_end,
+                  uint32_t color);
+    void drawTexturedSpan(const Tile& tile, const SpanTriangle& span, int y, int x_start,
+                          int x_end, const std::vector<uint32_t>& texture);
+    void drawRect(const Tile& tile, int x, int y, int width, int height, uint32_t color);
+    void drawLine(const Tile& tile, int x0, int y0, int x1, int y1, uint32_t color);
+    void drawTriangle(const Tile& tile, const Triangle& tri, uint32_t color);
+    void rasterizeTexturedTriangle(const Tile& tile, const Triangle& tri,
+                                   const std::vector<uint32_t>& textureBuffer);
+    void rasterizeTriangle1(const Tile& tile, const Triangle& tri, uint32_t color);
+    void rasterizeTriangle2(const Tile& tile, const Triangle& tri, uint32_t color);
+    void rasterizeFlatBottomTriangle(const Tile& tile, const Vector2i& p0, const Vector2i& p1,
+                                     const Vector2i& p2, uint32_t color);
+    void rasterizeFlatTopTriangle(const Tile& tile, const Vector2i& p0, const Vector2i& p1,
+                                  const Vector2i& p2, uint32_t color);
+    void binTriangles(const std::vector<Triangle>& triangles);
+    void rasterizeTile(size_t tileIndex);
     Eigen::Matrix4f lookAt(const Vector3f& eye, const Vector3f& target, const Vector3f& up);
     void renderColorBuffer();
-    void clearColorBuffer(uint32_t color);
-    void normalizeModel(std::vector<Vector3f>& vertices);
+    // whether rasterizing into the locked streaming texture saves the copy of the color buffer
+    bool zeroCopySupported() const;
+    // points the rasterizer at the locked texture, false if it could not be locked
+    bool lockColorTexture();
+    void unlockColorTexture();
+    // row y of the pixels being rasterized
+    uint32_t* colorRow(int y) { return _colorPixels + static_cast<size_t>(_colorPitch) * y; }
+    // resizes the color buffer, z-buffer and last triangles to scale times the window size
+    void applyRenderScale(float scale);
+    // copies the color buffer to the window and draws the HUD on top
+    void presentFrame(double timer_value);
+    void clearColorBuffer(const Tile& tile, uint32_t color);
+    void clearZBuffer(const Tile& tile);
+    static void normalizeModel(std::vector<Vector3f>& vertices);
     std::pair<bool, Vector3f> CullingCheck(const std::array<Vector3f, 3>& face_vertices);
     void constructProjectionMatrix(float fov, float aspectRatio, float znear, float zfar);
     void initializeFrustumPlanes(float fovX, float fovY, float zNear, float zFar);
     Polygon createPolygon(const Vector3f& a, const Vector3f& b, const Vector3f& c,
                           const Vector2f& a_uv, const Vector2f& b_uv, const Vector2f& c_uv);
     std::vector<Triangle> trianglesFromPolygons(const Polygon& polygon);
-    void clipPolygon(Polygon& polygon);
-    void clipPolygonAgainstPlane(Polygon& polygon, FRUSTUMPLANES plane);
-    Vector4f project(Vector4f& point);
+    // true if the polygon lost a part or all of it
+    bool clipPolygon(Polygon& polygon);
+    bool clipPolygonAgainstPlane(Polygon& polygon, FRUSTUMPLANES plane);
+    void cullOccludedTriangles(std::vector<Triangle>& triangles);
+    Vector4f project(const TransformMatrix& projection, const Vector4f& point);
+    void buildTrianglesToRender();
+    // faces or vertices [begin, end) of one mesh part, its vertices start at vertexOffset in
+    // _transformedVertices
+    struct FaceBatch {
+        const ModelData* part;
+        size_t vertexOffset;
+        size_t begin;
+        size_t end;
+    };
+    void processFaces(const FaceBatch& batch, std::vector<Triangle>& triangles);
+    bool isBoxInFrustum(const Eigen::Matrix4f& model_view, const Vector3f& min,
+                        const Vector3f& max) const;
+    void waitForGeometry();
     uint32_t calculateLightIntensityColor(uint32_t original_color, float percentage_factor);
-    bool loadObjFileData(const std::string& obj_file_path);
-    void loadPNGTextureData(const std::string& fileName);
-    void loadModelData(const std::string& file_path);
+    // loading runs on the model loader thread and only writes to the given model
+    static bool loadObjFileData(const std::string& obj_file_path, ModelData& model,
+                                bool optimize_mesh = false);
+    static void loadPNGTextureData(const std::string& fileName, ModelData& model);
+    static void loadModelData(const std::string& file_path, ModelData& model, bool optimize_mesh,
+                              bool quantize);
+    // asks the loader for the selected model and prefetches the next one in _pathes
+    void requestModels();
+    // replaces the mesh and texture once the model selected with Enter finished loading
+    void swapLoadedModel();
+    void applyModel(std::shared_ptr<const ModelData> model);
 
 private:
     Mesh _mesh;
@@ -131,21 +245,58 @@ private:
         Vector3f _forwardVelocity = {0.0f, 0.0f, 0.0f};
         float _yaw{0.0};  // roation around y axis ofthe camera
         float _pitch{0.0};  // rotation around x axis of the camera
+        uint64_t _version{0};  // bumped whenever the camera moves
     } _camera;
+
+    // Dirty tracking: the geometry stage only runs when one of these versions changed since the
+    // last triangles were built, and the color buffer is only rasterized again when the
+    // triangles or the render settings changed
+    struct SceneVersion {
+        uint64_t camera{};
+        uint64_t mesh{};
+        uint64_t settings{};
+        bool operator==(const SceneVersion&) const = default;
+    };
+    uint64_t _meshVersion{0};  // mesh data or mesh transform
+    uint64_t _settingsVersion{0};  // render mode and culling switches
+    uint64_t _trianglesVersion{0};  // _lastTrianglesToRender contents
+    std::optional<SceneVersion> _geometryVersion;
+    std::optional<std::pair<uint64_t, uint64_t>> _rasterizedVersion;
+    bool _colorBufferChanged{false};
  
     struct FrustumPlane {
         Vector3f _point;
         Vector3f _normal;
     };
 
+    // _trianglesToRender is filled by the geometry stage, _lastTrianglesToRender is rasterized,
+    // they are swapped once the geometry of a frame is done
     std::vector<Triangle> _trianglesToRender;
     std::vector<Triangle> _lastTrianglesToRender;
+    std::vector<std::vector<Triangle>> _chunkTriangles;  // geometry job outputs
+    // counted by the geometry and rasterization jobs for rasterizedPixels() and the profiler
+    // plots (profiling.hpp)
+    std::atomic<size_t> _clippedPolygons{0};
+    std::atomic<uint64_t> _rasterizedPixels{0};
+    uint64_t _lastRasterizedPixels{0};
+    std::vector<Vector3f> _transformedVertices;  // view space mesh vertices, faces index into it
+    std::vector<std::shared_ptr<const ModelData>> _meshParts;  // drawn by the geometry stage
+    std::unique_ptr<StreamingMesh> _streamingMesh;  // set when a .rstream file is shown
+    std::string _videoOutputPath;
+    VideoSink _videoSink;
+    size_t _streamingBudget{DEFAULT_STREAMING_BUDGET};
+    std::vector<std::vector<uint32_t>> _tileBins;  // indices into _lastTrianglesToRender per tile
+    JobHandle _geometryJob;
     std::vector<uint32_t> _colorBuffer;
-    std::vector<uint32_t> _meshTextureBuffer;
+    // _colorBuffer, or the locked texture while a zero-copy frame is rasterized
+    uint32_t* _colorPixels{nullptr};
+    int _colorPitch{};  // pixels from one row of _colorPixels to the next
+    bool _zeroCopyPresent{false};
     std::vector<float> _zBuffer;
     std::vector<float> _zBufferAlternative;
     std::vector<std::filesystem::path> _pathes;
     std::array<FrustumPlane, 6> frustumPlanes;
+    OcclusionBuffer _occlusionBuffer;
 
     std::unique_ptr<SDL_Window, decltype(&SDL_DestroyWindow)> _windowPtr =
         std::unique_ptr<SDL_Window, decltype(&SDL_DestroyWindow)>(nullptr, SDL_DestroyWindow);
@@ -160,24 +311,42 @@ private:
     Vector3f _lightDirection = {0.0, 0.0, 1.0};
 
     TTF_Font* _ttfTextRenerer = nullptr;
+    GlyphAtlas _glyphAtlas;
 
     std::vector<std::filesystem::path>::iterator _currentObjPathIt;
+    ModelLoader _modelLoader{[this](const std::string& path, ModelData& model) {
+        loadModelData(path, model, _optimizeMeshes, _quantizeMeshes);
+    }};
+    std::string _pendingModelPath;  // selected with Enter, shown once it is loaded
+    std::shared_ptr<const ModelData> _pendingModel;
 
     int _windowWidth{};
     int _windowHeight{};
-    int _textureWidth{};
-    int _textureHeight{};
+    int _renderWidth{};  // the window size unless dynamic resolution lowered it
+    int _renderHeight{};
+    bool _dynamicResolution{false};
+    ResolutionScaler _resolutionScaler;
+    std::chrono::steady_clock::time_point _frameStart;  // after the frame pacer
+    StageTimer _stageTimer;
+    std::string _stageTimingsPath;
 
-    uint32_t _previousFrameTime{0};
-    const uint32_t _fps{60};
-    const uint32_t _frameTargetTime{1000 / _fps};  //the time of one frame
+    std::string _fpsText;  // shown fps, refreshed twice a second
+    std::chrono::steady_clock::time_point _fpsTextTime;
+    uint32_t _fps{60};
+    double _frameTargetTime{1000.0 / _fps};  // milliseconds of one frame
+    FramePacer _framePacer{static_cast<double>(_fps)};
     float _deltaTime{};
 
     RenderMode _currentRenderMode = RenderMode::WIREFRAME;
     SDL_Color _renderModeTextColor = {255, 255, 255, 255};
 
     bool _isRunning = false;
+    bool _headless{false};
     bool _pause{false};
     bool _enableFaceCulling{true};
+    bool _enableOcclusionCulling{true};
     bool _rotateModel{false};
+    bool _pipelined{false};
+    bool _optimizeMeshes{false};
+    bool _quantizeMeshes{false};
 };
\ No newline at end of file
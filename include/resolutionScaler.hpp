@@ -0,0 +1,31 @@
+#pragma once
+// stl
+#include <array>
+#include <cstddef>
+
+// fractions of the window width and height, a 4K window goes down to 960x540
+constexpr std::array<float, 8> RESOLUTION_SCALE_STEPS{1.f,  0.85f, 0.7f,  0.6f,
+                                                      0.5f, 0.4f,  0.33f, 0.25f};
+constexpr int RESOLUTION_SCALE_BLOCK_FRAMES = 8;  // frame times are averaged over blocks
+constexpr int RESOLUTION_RAISE_BLOCKS = 8;  // blocks with headroom in a row before a step up
+// a step up is taken when its predicted frame time stays below this part of the budget
+constexpr double RESOLUTION_RAISE_HEADROOM = 0.7;
+
+// Picks the internal render resolution from measured frame times. A block of frames over the
+// frame budget on average drops one step, the scale climbs one step once the frame time of the
+// next step, predicted from the pixel count, fits the budget with headroom for
+// RESOLUTION_RAISE_BLOCKS blocks in a row. Every change starts the measurement over
+class ResolutionScaler {
+public:
+    void setBudget(double frame_ms) { _budgetMs = frame_ms; }
+    // time of a frame rendered at scale(), true when scale() changed
+    bool addFrameTime(double frame_ms);
+    float scale() const { return RESOLUTION_SCALE_STEPS[_step]; }
+
+private:
+    double _budgetMs{1000.0 / 60.0};
+    size_t _step{0};
+    int _blockFrames{0};
+    double _blockMs{0.0};
+    int _raiseBlocks{0};
+};
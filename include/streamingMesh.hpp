@@ -0,0 +1,78 @@
+#pragma once
+// stl
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+// internal
+#include "Mesh.hpp"
+#include "assetCache.hpp"
+#include "mappedFile.hpp"
+#include "modelLoader.hpp"
+
+constexpr uint32_t STREAM_FILE_VERSION = 1;  // bump whenever the .rstream layout changes
+constexpr size_t STREAM_CHUNK_FACES = 16384;  // upper bound of faces per spatial chunk
+constexpr size_t DEFAULT_STREAMING_BUDGET = size_t{512} << 20;  // bytes of resident chunks
+
+// chunk table entry of a .rstream file, the chunk payload (meshCache.hpp layout) is
+// self-contained: faces index the vertices of their own chunk
+struct StreamChunk {
+    std::array<float, 3> min;  // bounds of the chunk vertices in model space
+    std::array<float, 3> max;
+    uint64_t offset;  // of the payload from the start of the file
+    uint32_t numVertices;
+    uint32_t numFaces;
+
+    size_t byteSize(bool quantized = false) const {
+        if (quantized)
+            return numVertices * sizeof(QuantizedVertex) + numFaces * sizeof(QuantizedFace);
+        return numVertices * sizeof(Eigen::Vector3f) + numFaces * sizeof(Face);
+    }
+};
+
+// Splits a (normalized) model into spatial chunks of at most STREAM_CHUNK_FACES faces, cut at
+// the median face centroid along the longest axis, and writes them as a .rstream file.
+// Vertices shared by two chunks are stored in both
+bool writeStreamFile(const std::string& path, const ModelData& model);
+
+// Out-of-core rendering of a .rstream file. The file is memory mapped, only the chunk table is
+// read up front. Every frame the chunks inside the view frustum are requested nearest first until
+// the memory budget is used up, a loader thread decodes them into the cache and releases their
+// pages of the mapping again. Frames render whatever chunks are resident so far, unless update()
+// is asked to wait for them.
+class StreamingMesh {
+public:
+    using BoxVisibleFunc =
+        std::function<bool(const Eigen::Vector3f& min, const Eigen::Vector3f& max)>;
+
+    // quantize keeps the decoded chunks in the 16-bit format of meshQuantization.hpp
+    explicit StreamingMesh(size_t budget = DEFAULT_STREAMING_BUDGET, bool quantize = false);
+
+    // false if the file can not be mapped or is not a valid .rstream file
+    bool open(const std::string& path);
+    // selects the chunks to show for the model-view matrix, true if the resident set changed.
+    // wait_for_resident blocks until all of them are loaded instead of showing the ones loaded
+    // so far, for frames that have to be complete
+    bool update(const Eigen::Matrix4f& model_view, const BoxVisibleFunc& isVisible,
+                bool wait_for_resident = false);
+    const std::vector<std::shared_ptr<const ModelData>>& residentChunks() const {
+        return _resident;
+    }
+    size_t chunkCount() const { return _chunks.size(); }
+    AssetCacheStats stats() const { return _loader.cache().stats(); }
+
+private:
+    void loadChunk(const std::string& key, ModelData& chunk);
+
+private:
+    size_t _budget;
+    bool _quantize;
+    MappedFile _file;
+    std::vector<StreamChunk> _chunks;
+    std::vector<std::string> _keys;  // loader cache key of every chunk
+    std::vector<std::shared_ptr<const ModelData>> _resident;
+    // declared last, so the loader thread is stopped before the mapping goes away
+    ModelLoader _loader;
+};
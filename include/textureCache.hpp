@@ -0,0 +1,21 @@
+#pragma once
+// stl
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr uint32_t TEXTURE_CACHE_VERSION = 1;  // bump whenever the .rtex layout changes
+
+// Raw sidecar (<texture>.rtex next to <texture>.png) holding the decoded ABGR8888 pixels, so
+// later loads copy them out of the mapped file instead of decoding and converting the PNG. Like
+// the .rmesh file it is ignored when the size or modification time of the PNG changed, the
+// payload hash does not match or it was written by an other version
+std::string textureCachePath(const std::string& png_path);
+
+// false if there is no valid sidecar for png_path
+bool loadTextureCache(const std::string& png_path, std::vector<uint32_t>& texture, int& width,
+                      int& height);
+
+// false if the sidecar could not be written
+bool saveTextureCache(const std::string& png_path, const std::vector<uint32_t>& texture, int width,
+                      int height);
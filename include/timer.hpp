@@ -1,26 +1,28 @@
 #pragma once
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <filesystem>
 #include <string>
 
 using namespace std::string_literals;
 
-class Timer {   
+class Timer {
 public:
     Timer() = default;
 
     ~Timer() = default;
 
-    void startWatch() { 
-        _startWatchTime = std::chrono::steady_clock::now(); 
+    void startWatch() {
+        _startWatchTime = std::chrono::steady_clock::now();
     }
 
-    void endWatch() { 
-        _endWatchTime = std::chrono::steady_clock::now(); 
-        auto _time =
-            std::chrono::duration_cast<std::chrono::microseconds>(_endWatchTime - _startWatchTime)
-                .count();
+    void endWatch() {
+        _endWatchTime = std::chrono::steady_clock::now();
+        _frameTime = std::chrono::duration<double, std::micro>(_endWatchTime - _startWatchTime)
+                         .count();
         _fps = FPS();
     }
 
@@ -28,21 +30,76 @@ public:
         return _fps;
     }
 
+    // microseconds between the last startWatch() and endWatch()
+    double frameTime() const { return _frameTime; }
+
 private:
     double FPS() {
-        const auto& _start =
-            std::chrono::time_point_cast<std::chrono::microseconds>(_startWatchTime)
-                .time_since_epoch()
-                .count();
-        const auto& _end = std::chrono::time_point_cast<std::chrono::microseconds>(_endWatchTime)
-                               .time_since_epoch()
-                               .count();
-        auto fps = 1.0 / ((_end - _start) * 1.0e-6);
+        auto fps = 1.0 / (_frameTime * 1.0e-6);
         return fps;
     }
 
 private:
     std::chrono::time_point<std::chrono::steady_clock> _startWatchTime;
     std::chrono::time_point<std::chrono::steady_clock> _endWatchTime;
+    double _frameTime{};
     double _fps{};
 };
+
+// parts of a frame timed by StageTimer, FRAME is all of update() and render()
+enum class FrameStage { INPUT, TRANSFORM, CULL_CLIP, BIN, RASTER, HUD, PRESENT, FRAME };
+constexpr size_t FRAME_STAGE_COUNT = 8;
+constexpr std::array<const char*, FRAME_STAGE_COUNT> FRAME_STAGE_NAMES{
+    "input", "transform", "cull_clip", "bin", "raster", "hud", "present", "frame"};
+constexpr size_t STAGE_TIMING_SAMPLES = 1024;  // rolling window per stage, 17 s at 60 fps
+
+// milliseconds over the samples in the window
+struct StageStats {
+    uint64_t samples;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+};
+
+// Keeps the last STAGE_TIMING_SAMPLES durations of every stage in a ring buffer. Recording is
+// lock-free, so the geometry job of a pipelined frame records its stages next to the main
+// thread, and the stats can be read while frames are recorded
+class StageTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // records the time from its creation to stop() or its destruction
+    class Scope {
+    public:
+        Scope(StageTimer& timer, FrameStage stage)
+            : _timer(&timer), _stage(stage), _start(Clock::now()) {}
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() { stop(); }
+
+        void stop() {
+            if (_timer)
+                _timer->record(_stage, Clock::now() - _start);
+            _timer = nullptr;
+        }
+
+    private:
+        StageTimer* _timer;
+        FrameStage _stage;
+        Clock::time_point _start;
+    };
+
+    Scope measure(FrameStage stage) { return {*this, stage}; }
+    void record(FrameStage stage, Clock::duration time);
+    StageStats stats(FrameStage stage) const;
+    // the stats of every stage as csv, or as json for a .json path. "-" writes csv to stdout
+    bool save(const std::string& path) const;
+
+private:
+    struct Samples {
+        std::array<std::atomic<float>, STAGE_TIMING_SAMPLES> ms{};
+        std::atomic<uint64_t> count{0};
+    };
+    std::array<Samples, FRAME_STAGE_COUNT> _stages;
+};
@@ -0,0 +1,37 @@
+#pragma once
+// stl
+#include <algorithm>
+// 3rd-Party_Libs
+#include <Eigen/Dense>
+#ifdef RENDERER_SIMD_MATH
+// internal
+#include "matrix.hpp"
+#endif
+
+// The perspective projection of the geometry stage goes through these helpers so the math
+// backend is picked at build time: Eigen by default, the VCL specialized matrix.hpp / vector.hpp
+// with -DRENDERER_SIMD_MATH=ON. benchmark/renderer_benchmark.cpp compares both on the same
+// operations. The model-view transform of the mesh vertices is a dispatched kernel (kernels.hpp).
+#ifdef RENDERER_SIMD_MATH
+using TransformMatrix = mat4f_t;
+
+inline TransformMatrix toTransformMatrix(const Eigen::Matrix4f& m) {
+    static_assert(!Eigen::Matrix4f::IsRowMajor, "Matrix stores its values column by column");
+    TransformMatrix result;
+    std::copy_n(m.data(), 16, result.data());
+    return result;
+}
+
+inline Eigen::Vector4f transformPoint(const TransformMatrix& m, const Eigen::Vector3f& point) {
+    auto vec = m * vec4f_t{point.x(), point.y(), point.z(), 1.f};
+    return {vec.x(), vec.y(), vec.z(), vec.w()};
+}
+#else
+using TransformMatrix = Eigen::Matrix4f;
+
+inline TransformMatrix toTransformMatrix(const Eigen::Matrix4f& m) { return m; }
+
+inline Eigen::Vector4f transformPoint(const TransformMatrix& m, const Eigen::Vector3f& point) {
+    return m * Eigen::Vector4f{point.x(), point.y(), point.z(), 1.f};
+}
+#endif
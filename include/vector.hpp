@@ -1,188 +1,194 @@
 #pragma once
+#include <array>
 #include <cmath>
+#include <concepts>
 #include <cstdlib>
-#include <stdexcept>
 #include <tuple>
+#include <type_traits>
+// 3rd-Party_Libs
+#include "version2/vectorclass.h"
 
-namespace {
+// Fixed size vector, the dimension only exists at compile time: components which do not exist
+// for N are rejected by the requires clauses instead of throwing at runtime.
+// float vec4 arithmetic uses VCL Vec4f when it is not evaluated at compile time.
 template <typename T, size_t N>
 struct vector {
-public:
-    constexpr vector() noexcept : _x(0), _y(0), _z(0) {}
-    vector(T x, T y, T z = 0) : _x(x), _y(y), _z(z) { static_assert(N == 2 || N == 3); }
-
-    T& x() { return _x; }
-    T& y() { return _y; }
-    T& z() {
-        if (N == 2) {
-            throw std::invalid_argument("2D vectors have no z component.");
-        }
-        return _z;
-    }
-
-    T x() const { return _x; }
-    T y() const { return _y; }
-    T z() const {
-        if (N == 2) {
-            throw std::invalid_argument("2D vectors have no z component.");
-        }
-        return _z;
-    }
-
-    operator vector<int, N>() { 
-        auto x = static_cast<int>(this->x());
-        auto y = static_cast<int>(this->y());
-        if (N == 3) {
-            auto z = static_cast<int>(this->z());
-            return {x, y, z};
-        }
-        return {x, y};
-    }
+    static_assert(N >= 2 && N <= 4);
 
-    operator vector<float, N>() {
-        auto x = static_cast<float>(this->x());
-        auto y = static_cast<float>(this->y());
-        if (N == 3) {
-            auto z = static_cast<float>(this->z());
-            return {x, y, z};
+public:
+    constexpr vector() noexcept = default;
+    // missing trailing components are 0, vector<T, 3>{x, y} lies in the z = 0 plane
+    template <typename... Args>
+        requires(sizeof...(Args) >= 2 && sizeof...(Args) <= N &&
+                 (std::convertible_to<Args, T> && ...))
+    constexpr vector(Args... values) noexcept : _data{static_cast<T>(values)...} {}
+
+    constexpr T& x() { return _data[0]; }
+    constexpr T& y() { return _data[1]; }
+    constexpr T& z() requires(N >= 3) { return _data[2]; }
+    constexpr T& w() requires(N == 4) { return _data[3]; }
+
+    constexpr T x() const { return _data[0]; }
+    constexpr T y() const { return _data[1]; }
+    constexpr T z() const requires(N >= 3) { return _data[2]; }
+    constexpr T w() const requires(N == 4) { return _data[3]; }
+
+    constexpr T operator[](size_t i) const { return _data[i]; }
+    constexpr T& operator[](size_t i) { return _data[i]; }
+    constexpr const T* data() const { return _data.data(); }
+    constexpr T* data() { return _data.data(); }
+    static constexpr size_t size() { return N; }
+
+    template <typename U>
+    constexpr operator vector<U, N>() const {
+        vector<U, N> result;
+        for (size_t i = 0; i < N; i++) {
+            result[i] = static_cast<U>(_data[i]);
         }
-        return {x, y};
+        return result;
     }
 
-    void rotateAroundX(T angle) {
-        // static_assert(N == 3);
+    void rotateAroundX(T angle) requires(N >= 3) {
         //_x is the same
-        auto y = _y;
-        auto z = _z;
-        _y = y * cos(angle) - z * sin(angle);
-        _z = y * sin(angle) + z * cos(angle);
+        auto y = _data[1];
+        auto z = _data[2];
+        _data[1] = y * std::cos(angle) - z * std::sin(angle);
+        _data[2] = y * std::sin(angle) + z * std::cos(angle);
     }
 
-    void rotateAroundY(T angle) {
-        // static_assert(N == 3);
-        auto x = _x;
-        auto z = _z;
-        _x = x * cos(angle) - z * sin(angle);
+    void rotateAroundY(T angle) requires(N >= 3) {
+        auto x = _data[0];
+        auto z = _data[2];
+        _data[0] = x * std::cos(angle) - z * std::sin(angle);
         //_y is the same
-        _z = x * sin(angle) + z * cos(angle);
+        _data[2] = x * std::sin(angle) + z * std::cos(angle);
     }
 
     void rotateAroundZ(T angle) {
-        auto x = _x;
-        auto y = _y;
-        _x = x * cos(angle) - y * sin(angle);
-        _y = x * sin(angle) + y * cos(angle);
+        auto x = _data[0];
+        auto y = _data[1];
+        _data[0] = x * std::cos(angle) - y * std::sin(angle);
+        _data[1] = x * std::sin(angle) + y * std::cos(angle);
         //_z component is the same
     }
 
-    std::tuple<T, T, T> get() {
-        if (N == 3)
-            return {x(), y(), z()};
-        if (N == 2)
-            return {x(), y(), 0.f};
-    }
-
-    float magnitude() {
-        if (N == 2)
-            return std::sqrt(_x * _x + _y * _y);
+    constexpr std::tuple<T, T, T> get() const requires(N <= 3) {
+        if constexpr (N == 3)
+            return {_data[0], _data[1], _data[2]};
         else
-            return std::sqrt(_x * _x + _y * _y + _z * _z);
+            return {_data[0], _data[1], T{0}};
     }
 
-    vector<T, N> Add(const vector<T, N>& otherVec) {
-        _x = _x + otherVec.x();
-        _y = _y + otherVec.y();
-        if (N == 3)
-            _z = _z + otherVec.z();
-    }
+    constexpr T squaredMagnitude() const { return *this * *this; }
+    // not constexpr, std::sqrt is not constexpr before C++26
+    T magnitude() const { return std::sqrt(squaredMagnitude()); }
 
-    vector<T, N> operator+(const vector<T, N>& other) const {
-        if (N == 2)
-            return {(_x + other.x()), (_y + other.y())};
-        if (N == 3)
-            return {(_x + other.x()), (_y + other.y()), (_z + other.z())};
+    constexpr vector& Add(const vector& otherVec) {
+        *this = *this + otherVec;
+        return *this;
     }
 
-    void Subtract(const vector<T, N>& otherVec) {
-        _x = _x - otherVec.x();
-        _y = _y - otherVec.y();
-        if (N == 3)
-            _z = _z - otherVec.z();
+    constexpr vector operator+(const vector& other) const {
+        if constexpr (isVec4f) {
+            if !consteval {
+                return fromVec4f(toVec4f() + other.toVec4f());
+            }
+        }
+        vector result;
+        for (size_t i = 0; i < N; i++) {
+            result._data[i] = _data[i] + other._data[i];
+        }
+        return result;
     }
 
-    vector<T, N> operator-(const vector<T, N>& other) const {
-        if (N == 2)
-            return {(_x - other.x()), (_y - other.y())};
-        if (N == 3)
-            return {(_x - other.x()), (_y - other.y()), (_z - other.z())};
+    constexpr vector& Subtract(const vector& otherVec) {
+        *this = *this - otherVec;
+        return *this;
     }
 
-    void scale(float factor) {
-        _x *= factor;
-        _y *= factor;
-        if (N == 3)
-            _z *= factor;
+    constexpr vector operator-(const vector& other) const {
+        if constexpr (isVec4f) {
+            if !consteval {
+                return fromVec4f(toVec4f() - other.toVec4f());
+            }
+        }
+        vector result;
+        for (size_t i = 0; i < N; i++) {
+            result._data[i] = _data[i] - other._data[i];
+        }
+        return result;
     }
 
-    void divide(float factor) {
-        _x /= factor;
-        _y /= factor;
-        if (N == 3)
-            _z /= factor;
+    constexpr void scale(T factor) { *this = *this * factor; }
+
+    constexpr void divide(T factor) {
+        for (auto& component : _data) {
+            component /= factor;
+        }
     }
 
     // cross product
-    vector<T, 3> operator^(const vector<T, 3>& other) const {
-        return {(_y * other.z() - _z * other.y()), (_z * other.x() - _x * other.z()),
-                (_x * other.y() - _y * other.x())};
+    constexpr vector<T, 3> operator^(const vector<T, 3>& other) const requires(N == 3) {
+        return {(_data[1] * other.z() - _data[2] * other.y()),
+                (_data[2] * other.x() - _data[0] * other.z()),
+                (_data[0] * other.y() - _data[1] * other.x())};
     }
 
     // dot product
-    float operator*(const vector<T, N>& other) const {
-        if (N == 2)
-            return _x * other.x() + _y * other.y();
-        if (N == 3)
-            return _x * other.x() + _y * other.y() + _z * other.z();
+    constexpr T operator*(const vector& other) const {
+        if constexpr (isVec4f) {
+            if !consteval {
+                return horizontal_add(toVec4f() * other.toVec4f());
+            }
+        }
+        T result{0};
+        for (size_t i = 0; i < N; i++) {
+            result += _data[i] * other._data[i];
+        }
+        return result;
     }
 
-    vector<T, N> operator*(T scale_value) const {
-        if (N == 2)
-            return {_x * scale_value, _y * scale_value};
-        if (N == 3)
-            return {_x * scale_value, _y * scale_value, _z * scale_value};
+    constexpr vector operator*(T scale_value) const {
+        if constexpr (isVec4f) {
+            if !consteval {
+                return fromVec4f(toVec4f() * scale_value);
+            }
+        }
+        vector result;
+        for (size_t i = 0; i < N; i++) {
+            result._data[i] = _data[i] * scale_value;
+        }
+        return result;
     }
 
-    void normalize() {
-        auto mag = this->magnitude();
-        _x /= mag;
-        _y /= mag;
-        if (N == 3)
-            _z /= mag;
-    }
+    void normalize() { divide(magnitude()); }
+
+    constexpr std::tuple<T, T> get2() const requires(N == 2) { return {_data[0], _data[1]}; }
 
-    std::tuple<T, T> get2() {
-        if (N == 2)
-            return {_x, _y};
+    constexpr std::tuple<T, T, T> get3() const requires(N == 3) {
+        return {_data[0], _data[1], _data[2]};
     }
 
-    std::tuple<T, T, T> get3() {
-        if (N == 3)
-            return {_x, _y, _z};
+private:
+    static constexpr bool isVec4f = std::is_same_v<T, float> && N == 4;
+
+    Vec4f toVec4f() const requires isVec4f { return Vec4f().load(_data.data()); }
+    static vector fromVec4f(const Vec4f& v) requires isVec4f {
+        vector result;
+        v.store(result._data.data());
+        return result;
     }
 
 private:
-    T _x{0};
-    T _y{0};
-    T _z{0};
+    std::array<T, N> _data{};
 };
 
 using vec2f_t = vector<float, 2>;
 using vec3f_t = vector<float, 3>;
+using vec4f_t = vector<float, 4>;
 
 using vec2i_t = vector<int, 2>;
 using vec3i_t = vector<int, 3>;
 
 using vec2d_t = vector<double, 2>;
 using vec3d_t = vector<double, 3>;
-
-}  // namespace
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+// stl
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr size_t VIDEO_SINK_QUEUE_FRAMES = 3;  // submitted frames waiting for the sink thread
+
+// Streams frames as a YUV4MPEG2 (.y4m) video of I420 frames to a file or, for the path "-", to
+// stdout, for piping into an encoder (ffmpeg -i - ...). submit() copies the frame into one of
+// VIDEO_SINK_QUEUE_FRAMES buffers and returns, the YUV conversion (Kernels::convertToI420) and
+// the writes run on the sink thread. When all buffers are queued submit() waits for the sink, or
+// drops the frame if the sink was opened with drop_when_full
+class VideoSink {
+public:
+    ~VideoSink();
+    bool open(const std::string& path, int width, int height, int fps, bool drop_when_full);
+    // ABGR8888 pixels of width x height
+    void submit(const std::vector<uint32_t>& frame);
+    // writes the queued frames and closes the stream
+    void close();
+    bool isOpen() const { return _file != nullptr; }
+    size_t framesWritten() const;
+    size_t framesDropped() const;
+
+private:
+    void writeFrames();
+    void convertFrame(const std::vector<uint32_t>& frame);
+
+private:
+    std::FILE* _file{nullptr};
+    int _width{};
+    int _height{};
+    bool _dropWhenFull{false};
+    std::vector<uint8_t> _planes;  // y, u and v of the frame being written
+
+    mutable std::mutex _mutex;
+    std::condition_variable _frameQueued;
+    std::condition_variable _bufferFreed;
+    std::deque<std::vector<uint32_t>> _queued;
+    std::vector<std::vector<uint32_t>> _free;
+    bool _closing{false};
+    bool _failed{false};
+    size_t _framesWritten{0};
+    size_t _framesDropped{0};
+    std::thread _thread;
+};
@@ -0,0 +1,82 @@
+//STL
+#include <algorithm>
+//INTERNAL
+#include <assetCache.hpp>
+
+AssetCache::AssetCache(size_t budget) {
+    _stats.budget = budget;
+}
+
+std::shared_ptr<const ModelData> AssetCache::get(const std::string& path) {
+    std::lock_guard lock(_mutex);
+    auto it = _index.find(path);
+    if (it == _index.end()) {
+        _stats.misses++;
+        return nullptr;
+    }
+    _stats.hits++;
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return it->second->model;
+}
+
+std::shared_ptr<const ModelData> AssetCache::peek(const std::string& path) const {
+    std::lock_guard lock(_mutex);
+    auto it = _index.find(path);
+    return it == _index.end() ? nullptr : it->second->model;
+}
+
+bool AssetCache::contains(const std::string& path) const {
+    std::lock_guard lock(_mutex);
+    return _index.contains(path);
+}
+
+void AssetCache::put(const std::string& path, std::shared_ptr<const ModelData> model) {
+    std::lock_guard lock(_mutex);
+    if (auto it = _index.find(path); it != _index.end()) {
+        _stats.bytes -= it->second->bytes;
+        _entries.erase(it->second);
+        _index.erase(it);
+    }
+    auto bytes = model->byteSize();
+    _entries.push_front({path, std::move(model), bytes});
+    _index[path] = _entries.begin();
+    _stats.bytes += bytes;
+    evict();
+}
+
+void AssetCache::setPinned(std::vector<std::string> paths) {
+    std::lock_guard lock(_mutex);
+    _pinned = std::move(paths);
+    evict();
+}
+
+void AssetCache::setBudget(size_t budget) {
+    std::lock_guard lock(_mutex);
+    _stats.budget = budget;
+    evict();
+}
+
+AssetCacheStats AssetCache::stats() const {
+    std::lock_guard lock(_mutex);
+    auto stats = _stats;
+    stats.entries = _entries.size();
+    return stats;
+}
+
+void AssetCache::evict() {
+    // least recently used first, pinned entries are skipped
+    auto it = _entries.end();
+    while (_stats.bytes > _stats.budget && it != _entries.begin()) {
+        --it;
+        if (isPinned(it->path))
+            continue;
+        _stats.bytes -= it->bytes;
+        _stats.evictions++;
+        _index.erase(it->path);
+        it = _entries.erase(it);
+    }
+}
+
+bool AssetCache::isPinned(const std::string& path) const {
+    return std::find(_pinned.begin(), _pinned.end(), path) != _pinned.end();
+}
@@ -0,0 +1,41 @@
+//STL
+#include <algorithm>
+#include <thread>
+//INTERNAL
+#include <framePacer.hpp>
+
+void FramePacer::setTargetRate(double rate) {
+    _rate = std::max(rate, 0.0);
+    _period = _rate > 0.0 ? std::chrono::duration_cast<Clock::duration>(
+                                std::chrono::duration<double>(1.0 / _rate))
+                          : Clock::duration::zero();
+    _deadline = _previousFrame + _period;
+}
+
+double FramePacer::wait() {
+    if (!_started) {
+        _started = true;
+        _previousFrame = Clock::now();
+        _deadline = _previousFrame + _period;
+        return std::chrono::duration<double>(_period).count();
+    }
+    if (_period > Clock::duration::zero()) {
+        auto sleep_until = _deadline - _spinTime;
+        if (Clock::now() < sleep_until) {
+            std::this_thread::sleep_until(sleep_until);
+            // the spin covers the overshoot of the recent sleeps, it shrinks slowly again
+            auto overshoot = Clock::now() - sleep_until;
+            _spinTime = std::clamp<Clock::duration>(
+                std::max(_spinTime - _spinTime / 16, overshoot + FRAME_PACER_MIN_SPIN_TIME),
+                FRAME_PACER_MIN_SPIN_TIME, FRAME_PACER_MAX_SPIN_TIME);
+        }
+        while (Clock::now() < _deadline) {}
+    }
+    auto now = Clock::now();
+    double delta = std::chrono::duration<double>(now - _previousFrame).count();
+    _previousFrame = now;
+    _deadline += _period;
+    if (_deadline < now)
+        _deadline = now + _period;
+    return delta;
+}
@@ -0,0 +1,95 @@
+//STL
+#include <algorithm>
+#include <iostream>
+//INTERNAL
+#include <glyphAtlas.hpp>
+
+bool GlyphAtlas::build(SDL_Renderer* renderer, TTF_Font* font) {
+    _texture.reset();
+    _layouts.clear();
+    if (!font)
+        return false;
+    _height = TTF_FontHeight(font);
+
+    // every glyph is rendered like a one character string, so the quads line up like the
+    // glyphs of a rendered string
+    std::array<SDL_Surface*, GLYPH_ATLAS_LAST - GLYPH_ATLAS_FIRST + 1> surfaces{};
+    int x{0};
+    int y{0};
+    for (size_t i{0}; i < surfaces.size(); i++) {
+        auto character = static_cast<uint16_t>(GLYPH_ATLAS_FIRST + i);
+        surfaces[i] = TTF_RenderGlyph_Blended(font, character, {255, 255, 255, 255});
+        int advance{0};
+        TTF_GlyphMetrics(font, character, nullptr, nullptr, nullptr, nullptr, &advance);
+        int width = surfaces[i] ? surfaces[i]->w : 0;
+        if (x + width > GLYPH_ATLAS_WIDTH) {
+            x = 0;
+            y += _height;
+        }
+        _glyphs[i] = {{x, y, width, _height}, advance};
+        x += width;
+    }
+
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, GLYPH_ATLAS_WIDTH, y + _height, 32,
+                                                        SDL_PIXELFORMAT_ABGR8888);
+    if (atlas) {
+        for (size_t i{0}; i < surfaces.size(); i++) {
+            if (!surfaces[i])
+                continue;
+            // the glyph coverage is copied into the alpha channel as it is
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_Rect target = _glyphs[i].source;
+            SDL_BlitSurface(surfaces[i], nullptr, atlas, &target);
+        }
+        _texture.reset(SDL_CreateTextureFromSurface(renderer, atlas));
+        SDL_FreeSurface(atlas);
+    }
+    for (auto* surface : surfaces)
+        SDL_FreeSurface(surface);
+    if (!_texture) {
+        std::cerr << "Failed to create the glyph atlas: " << SDL_GetError() << '\n';
+        return false;
+    }
+    SDL_SetTextureBlendMode(_texture.get(), SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+void GlyphAtlas::draw(SDL_Renderer* renderer, std::string_view text, const SDL_Rect& box,
+                      SDL_Color color) {
+    if (!_texture)
+        return;
+    const auto& text_layout = layout(text);
+    if (text_layout.width == 0)
+        return;
+    float scale_x = static_cast<float>(box.w) / text_layout.width;
+    float scale_y = static_cast<float>(box.h) / _height;
+    SDL_SetTextureColorMod(_texture.get(), color.r, color.g, color.b);
+    for (const auto& quad : text_layout.quads) {
+        SDL_Rect target{box.x + static_cast<int>(quad.x * scale_x), box.y,
+                        static_cast<int>(quad.source.w * scale_x + 0.5f),
+                        static_cast<int>(quad.source.h * scale_y + 0.5f)};
+        SDL_RenderCopy(renderer, _texture.get(), &quad.source, &target);
+    }
+}
+
+const GlyphAtlas::TextLayout& GlyphAtlas::layout(std::string_view text) {
+    std::string key(text);
+    if (auto it = _layouts.find(key); it != _layouts.end())
+        return it->second;
+    if (_layouts.size() >= TEXT_LAYOUT_CACHE_SIZE)
+        _layouts.clear();
+
+    TextLayout text_layout{{}, 0};
+    int pen{0};
+    for (char character : text) {
+        if (character < GLYPH_ATLAS_FIRST || character > GLYPH_ATLAS_LAST)
+            character = '?';
+        const auto& glyph = _glyphs[character - GLYPH_ATLAS_FIRST];
+        if (glyph.source.w > 0)
+            text_layout.quads.push_back({glyph.source, pen});
+        // the last glyph may reach past its advance
+        text_layout.width = std::max(text_layout.width, pen + glyph.source.w);
+        pen += glyph.advance;
+    }
+    return _layouts.emplace(std::move(key), std::move(text_layout)).first->second;
+}
@@ -0,0 +1,61 @@
+//STL
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+//INTERNAL
+#include <imageWriter.hpp>
+//3RD-PARTY
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+namespace {
+bool writePPM(const std::string& path, const std::vector<uint32_t>& pixels, int width,
+              int height) {
+    std::vector<unsigned char> rgb(pixels.size() * 3);
+    for (size_t i{0}; i < pixels.size(); i++) {
+        // ABGR8888 holds R in the low byte
+        rgb[3 * i] = pixels[i] & 0xFF;
+        rgb[3 * i + 1] = (pixels[i] >> 8) & 0xFF;
+        rgb[3 * i + 2] = (pixels[i] >> 16) & 0xFF;
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "P6\n" << width << ' ' << height << "\n255\n";
+    out.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+    return static_cast<bool>(out);
+}
+
+bool writePNG(const std::string& path, const std::vector<uint32_t>& pixels, int width,
+              int height) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        const_cast<uint32_t*>(pixels.data()), width, height, 32,
+        width * static_cast<int>(sizeof(uint32_t)), SDL_PIXELFORMAT_ABGR8888);
+    if (!surface) {
+        std::cerr << "Failed to create surface: " << SDL_GetError() << '\n';
+        return false;
+    }
+    bool written = IMG_SavePNG(surface, path.c_str()) == 0;
+    SDL_FreeSurface(surface);
+    return written;
+}
+}  // namespace
+
+bool writeImage(const std::string& path, const std::vector<uint32_t>& pixels, int width,
+                int height) {
+    if (pixels.size() != static_cast<size_t>(width) * height) {
+        std::cerr << "Image size does not match the pixels: " << path << '\n';
+        return false;
+    }
+    auto extension = std::filesystem::path(path).extension();
+    bool written{false};
+    if (extension == ".ppm") {
+        written = writePPM(path, pixels, width, height);
+    } else if (extension == ".png") {
+        written = writePNG(path, pixels, width, height);
+    } else {
+        std::cerr << "Unsupported image format: " << path << '\n';
+        return false;
+    }
+    if (!written)
+        std::cerr << "Failed to write image: " << path << '\n';
+    return written;
+}
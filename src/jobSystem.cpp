@@ -0,0 +1,138 @@
+//STL
+#include <string>
+//INTERNAL
+#include <jobSystem.hpp>
+#include <profiling.hpp>
+
+namespace {
+// index into JobSystem::_queues of the calling thread, 0 for threads which are not workers
+thread_local int t_queueIndex = 0;
+}  // namespace
+
+JobSystem::JobSystem(unsigned numWorkers) {
+    _queues.reserve(numWorkers + 1);
+    for (unsigned i{0}; i <= numWorkers; i++) {
+        _queues.push_back(std::make_unique<JobQueue>());
+    }
+    _workers.reserve(numWorkers);
+    for (unsigned i{0}; i < numWorkers; i++) {
+        _workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(_sleepMutex);
+        _stop = true;
+    }
+    _wakeUp.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+JobSystem& JobSystem::instance() {
+    static JobSystem jobSystem(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return jobSystem;
+}
+
+JobHandle JobSystem::createJob(std::function<void()> task, const JobHandle& parent) {
+    auto job = std::make_shared<Job>();
+    job->task = std::move(task);
+    job->parent = parent;
+    if (parent)
+        parent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::run(const JobHandle& job) {
+    auto& queue = *_queues[t_queueIndex];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+    _queuedJobs.fetch_add(1, std::memory_order_release);
+    {
+        // taking the lock makes sure a worker going to sleep sees the new job or the notify
+        std::lock_guard lock(_sleepMutex);
+    }
+    _wakeUp.notify_one();
+}
+
+void JobSystem::wait(const JobHandle& job) {
+    while (!isFinished(job)) {
+        if (auto next = findJob(t_queueIndex)) {
+            execute(next);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::isFinished(const JobHandle& job) const {
+    return job->unfinishedJobs.load(std::memory_order_acquire) == 0;
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    t_queueIndex = static_cast<int>(index);
+    PROFILE_THREAD_NAME(("Job worker " + std::to_string(index)).c_str());
+    while (true) {
+        if (auto job = findJob(t_queueIndex)) {
+            execute(job);
+            continue;
+        }
+        std::unique_lock lock(_sleepMutex);
+        _wakeUp.wait(lock, [this] {
+            return _stop || _queuedJobs.load(std::memory_order_acquire) > 0;
+        });
+        if (_stop)
+            return;
+    }
+}
+
+JobHandle JobSystem::popJob(int queueIndex) {
+    auto& queue = *_queues[queueIndex];
+    std::lock_guard lock(queue.mutex);
+    if (queue.jobs.empty())
+        return nullptr;
+    JobHandle job;
+    if (queueIndex == t_queueIndex) {
+        // own queue, the most recent job is still hot in the cache
+        job = std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+    } else {
+        // steal the oldest job, it is usually the biggest piece of remaining work
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+    }
+    _queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+JobHandle JobSystem::findJob(int queueIndex) {
+    if (auto job = popJob(queueIndex))
+        return job;
+    if (_queuedJobs.load(std::memory_order_acquire) == 0)
+        return nullptr;
+    // steal, start at the next queue so the thieves spread over the victims
+    auto numQueues = static_cast<int>(_queues.size());
+    for (int i{1}; i < numQueues; i++) {
+        if (auto job = popJob((queueIndex + i) % numQueues))
+            return job;
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(const JobHandle& job) {
+    if (job->task)
+        job->task();
+    finish(job);
+}
+
+void JobSystem::finish(const JobHandle& job) {
+    if (job->unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (job->parent)
+            finish(job->parent);
+        job->task = nullptr;  // release whatever the task captured
+    }
+}
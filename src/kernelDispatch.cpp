@@ -0,0 +1,32 @@
+//INTERNAL
+#include <kernels.hpp>
+//3RD-PARTY
+#include "version2/instrset.h"
+
+// one table per compiled variant of kernels.cpp
+namespace Ns_SSE2 {
+const Kernels& getKernels();
+}
+namespace Ns_AVX2 {
+const Kernels& getKernels();
+}
+namespace Ns_AVX512 {
+const Kernels& getKernels();
+}
+
+namespace {
+const Kernels& selectKernels() {
+    // instruction set levels of instrset_detect(): 8 = AVX2, 10 = AVX512F/VL/BW/DQ
+    int level = instrset_detect();
+    if (level >= 10)
+        return Ns_AVX512::getKernels();
+    if (level >= 8 && hasFMA3())
+        return Ns_AVX2::getKernels();
+    return Ns_SSE2::getKernels();
+}
+}  // namespace
+
+const Kernels& kernels() {
+    static const Kernels& selected = selectKernels();
+    return selected;
+}
@@ -0,0 +1,326 @@
+// Compiled once per instruction set, see the RendererKernels_* targets in CMakeLists.txt.
+// KERNEL_NAMESPACE and VCL_NAMESPACE differ per variant so no symbol, not even an inline VCL
+// function, is shared between the variants and the linker can not mix them up.
+// the math follows the scalar code operation by operation and multiply-adds are not fused, so
+// every variant produces the same pixels
+//STL
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+//INTERNAL
+#include <kernels.hpp>
+//3RD-PARTY
+#include "version2/vectorclass.h"
+
+#ifndef KERNEL_NAMESPACE
+#error "KERNEL_NAMESPACE has to be defined by the build"
+#endif
+
+namespace KERNEL_NAMESPACE {
+#ifdef VCL_NAMESPACE
+using namespace VCL_NAMESPACE;
+#endif
+
+namespace {
+// the widest vectors of the instruction set for the per-pixel kernels
+#if INSTRSET >= 9
+using FloatVec = Vec16f;
+using IntVec = Vec16i;
+#elif INSTRSET >= 8
+using FloatVec = Vec8f;
+using IntVec = Vec8i;
+#else
+using FloatVec = Vec4f;
+using IntVec = Vec4i;
+#endif
+constexpr int LANES = FloatVec::size();
+
+alignas(64) constexpr float LANE_OFFSETS[16] = {0.f, 1.f, 2.f,  3.f,  4.f,  5.f,  6.f,  7.f,
+                                                8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f};
+
+struct SpanPixels {
+    FloatVec alpha;
+    FloatVec beta;
+    FloatVec gamma;
+    FloatVec reciprocal_w;
+};
+
+// barycentric weights and interpolated 1/w of the pixel centers px on row py
+SpanPixels interpolate(const SpanTriangle& tri, float py, FloatVec px) {
+    float ac_x = tri.cx - tri.ax;
+    float ac_y = tri.cy - tri.ay;
+    float ab_x = tri.bx - tri.ax;
+    float ab_y = tri.by - tri.ay;
+    float area_parallelogram_abc = ac_x * ab_y - ac_y * ab_x;
+
+    FloatVec pc_x = tri.cx - px;
+    float pc_y = tri.cy - py;
+    FloatVec pb_x = tri.bx - px;
+    float pb_y = tri.by - py;
+    FloatVec ap_x = px - tri.ax;
+    float ap_y = py - tri.ay;
+
+    SpanPixels pixels;
+    pixels.alpha = (pc_x * pb_y - pc_y * pb_x) / area_parallelogram_abc;
+    pixels.beta = (ac_x * ap_y - ac_y * ap_x) / area_parallelogram_abc;
+    pixels.gamma = 1.f - pixels.alpha - pixels.beta;
+    pixels.reciprocal_w =
+        tri.inv_aw * pixels.alpha + tri.inv_bw * pixels.beta + tri.inv_cw * pixels.gamma;
+    return pixels;
+}
+
+// rows of the upper 3x4 part of a column-major matrix, the last row is not needed, the result
+// stays in view space. scale multiplies the 3x3 part, so it applies to the input positions
+struct AffineRows {
+    float m00, m01, m02, m03;
+    float m10, m11, m12, m13;
+    float m20, m21, m22, m23;
+};
+
+AffineRows affineRows(const float* matrix, float scale) {
+    return {matrix[0] * scale, matrix[4] * scale, matrix[8] * scale,  matrix[12],
+            matrix[1] * scale, matrix[5] * scale, matrix[9] * scale,  matrix[13],
+            matrix[2] * scale, matrix[6] * scale, matrix[10] * scale, matrix[14]};
+}
+
+// a, b and c hold x0 y0 z0 x1 y1 z1 ... of 8 vertices
+void transform8(const AffineRows& m, Vec8f a, Vec8f b, Vec8f c, float* dst) {
+    // deinterleave
+    Vec8f x = blend8<0, 3, 6, 9, 12, 15, V_DC, V_DC>(a, b);
+    Vec8f y = blend8<1, 4, 7, 10, 13, V_DC, V_DC, V_DC>(a, b);
+    Vec8f z = blend8<2, 5, 8, 11, 14, V_DC, V_DC, V_DC>(a, b);
+    x = blend8<0, 1, 2, 3, 4, 5, 10, 13>(x, c);
+    y = blend8<0, 1, 2, 3, 4, 8, 11, 14>(y, c);
+    z = blend8<0, 1, 2, 3, 4, 9, 12, 15>(z, c);
+
+    Vec8f rx = x * m.m00 + y * m.m01 + z * m.m02 + m.m03;
+    Vec8f ry = x * m.m10 + y * m.m11 + z * m.m12 + m.m13;
+    Vec8f rz = x * m.m20 + y * m.m21 + z * m.m22 + m.m23;
+
+    // interleave again
+    a = blend8<0, 8, V_DC, 1, 9, V_DC, 2, 10>(rx, ry);
+    b = blend8<V_DC, 3, 11, V_DC, 4, 12, V_DC, 5>(rx, ry);
+    c = blend8<13, V_DC, 6, 14, V_DC, 7, 15, V_DC>(rx, ry);
+    blend8<0, 1, 8, 3, 4, 9, 6, 7>(a, rz).store(dst);
+    blend8<10, 1, 2, 11, 4, 5, 12, 7>(b, rz).store(dst + 8);
+    blend8<0, 13, 2, 3, 14, 5, 6, 15>(c, rz).store(dst + 16);
+}
+
+void transform1(const AffineRows& m, float x, float y, float z, float* dst) {
+    dst[0] = x * m.m00 + y * m.m01 + z * m.m02 + m.m03;
+    dst[1] = x * m.m10 + y * m.m11 + z * m.m12 + m.m13;
+    dst[2] = x * m.m20 + y * m.m21 + z * m.m22 + m.m23;
+}
+
+// 8 signed 16-bit values as floats
+Vec8f toFloat8(Vec8s values) {
+    return to_float(Vec8i(extend_low(values), extend_high(values)));
+}
+
+void transformVertices(const float* matrix, const float* vertices, float* out, size_t count) {
+    const auto m = affineRows(matrix, 1.f);
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        const float* src = vertices + 3 * i;
+        transform8(m, Vec8f().load(src), Vec8f().load(src + 8), Vec8f().load(src + 16),
+                   out + 3 * i);
+    }
+    for (; i < count; i++) {
+        transform1(m, vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2], out + 3 * i);
+    }
+}
+
+void transformQuantizedVertices(const float* matrix, const int16_t* vertices, float scale,
+                                float* out, size_t count) {
+    // the dequantization is folded into the matrix: M * (q * scale) = (M * scale) * q
+    const auto m = affineRows(matrix, scale);
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        const int16_t* src = vertices + 3 * i;
+        transform8(m, toFloat8(Vec8s().load(src)), toFloat8(Vec8s().load(src + 8)),
+                   toFloat8(Vec8s().load(src + 16)), out + 3 * i);
+    }
+    for (; i < count; i++) {
+        transform1(m, vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2], out + 3 * i);
+    }
+}
+
+void fillColor(uint32_t* colors, size_t count, uint32_t color) {
+    const IntVec value(static_cast<int32_t>(color));
+    size_t i{0};
+    for (; i + LANES <= count; i += LANES) {
+        value.store(colors + i);
+    }
+    if (i < count)
+        value.store_partial(static_cast<int>(count - i), colors + i);
+}
+
+void fillDepth(float* depths, size_t count, float depth) {
+    const FloatVec value(depth);
+    size_t i{0};
+    for (; i + LANES <= count; i += LANES) {
+        value.store(depths + i);
+    }
+    if (i < count)
+        value.store_partial(static_cast<int>(count - i), depths + i);
+}
+
+// BT.601 limited range in the 8-bit fixed point form of libyuv and ffmpeg, for ints and Vec8i
+template <typename T>
+T lumaOf(T r, T g, T b) {
+    return ((r * 66 + g * 129 + b * 25 + 128) >> 8) + 16;
+}
+
+template <typename T>
+T chromaUOf(T r, T g, T b) {
+    return ((r * -38 + g * -74 + b * 112 + 128) >> 8) + 128;
+}
+
+template <typename T>
+T chromaVOf(T r, T g, T b) {
+    return ((r * 112 + g * -94 + b * -18 + 128) >> 8) + 128;
+}
+
+// 16 values which fit into a byte
+void storeBytes16(Vec8i low, Vec8i high, uint8_t* dst) {
+    Vec16s words = compress(low, high);
+    compress(words.get_low(), words.get_high()).store(dst);
+}
+
+void storeBytes8(Vec8i values, uint8_t* dst) {
+    Vec8s words = compress(values, values).get_low();
+    compress(words, words).store_partial(8, dst);
+}
+
+void convertToI420(const uint32_t* row0, const uint32_t* row1, int width, uint8_t* y0,
+                   uint8_t* y1, uint8_t* u, uint8_t* v) {
+    const Vec8i mask(0xFF);
+    int x{0};
+    for (; x + 16 <= width; x += 16) {
+        // r g b of the pixels x..x+7 (a) and x+8..x+15 (b) of both rows
+        Vec8i a0 = Vec8i().load(row0 + x);
+        Vec8i b0 = Vec8i().load(row0 + x + 8);
+        Vec8i a1 = Vec8i().load(row1 + x);
+        Vec8i b1 = Vec8i().load(row1 + x + 8);
+        Vec8i ra0 = a0 & mask, ga0 = (a0 >> 8) & mask, ba0 = (a0 >> 16) & mask;
+        Vec8i rb0 = b0 & mask, gb0 = (b0 >> 8) & mask, bb0 = (b0 >> 16) & mask;
+        Vec8i ra1 = a1 & mask, ga1 = (a1 >> 8) & mask, ba1 = (a1 >> 16) & mask;
+        Vec8i rb1 = b1 & mask, gb1 = (b1 >> 8) & mask, bb1 = (b1 >> 16) & mask;
+        storeBytes16(lumaOf(ra0, ga0, ba0), lumaOf(rb0, gb0, bb0), y0 + x);
+        storeBytes16(lumaOf(ra1, ga1, ba1), lumaOf(rb1, gb1, bb1), y1 + x);
+
+        // average of every 2x2 block, the even plus the odd pixels of both rows
+        auto block = [](Vec8i a0, Vec8i b0, Vec8i a1, Vec8i b1) {
+            Vec8i rows_a = a0 + a1;
+            Vec8i rows_b = b0 + b1;
+            Vec8i sum = blend8<0, 2, 4, 6, 8, 10, 12, 14>(rows_a, rows_b) +
+                        blend8<1, 3, 5, 7, 9, 11, 13, 15>(rows_a, rows_b);
+            return (sum + 2) >> 2;
+        };
+        Vec8i r = block(ra0, rb0, ra1, rb1);
+        Vec8i g = block(ga0, gb0, ga1, gb1);
+        Vec8i b = block(ba0, bb0, ba1, bb1);
+        storeBytes8(chromaUOf(r, g, b), u + x / 2);
+        storeBytes8(chromaVOf(r, g, b), v + x / 2);
+    }
+    // the remaining blocks one at a time, the last column of an odd width is counted twice
+    for (; x < width; x += 2) {
+        int r{0}, g{0}, b{0};
+        for (int dx{0}; dx < 2; dx++) {
+            int column = std::min(x + dx, width - 1);
+            for (const uint32_t* row : {row0, row1}) {
+                uint32_t pixel = row[column];
+                r += pixel & 0xFF;
+                g += (pixel >> 8) & 0xFF;
+                b += (pixel >> 16) & 0xFF;
+            }
+        }
+        for (int dx{0}; dx < 2 && x + dx < width; dx++) {
+            uint32_t p0 = row0[x + dx];
+            uint32_t p1 = row1[x + dx];
+            y0[x + dx] =
+                static_cast<uint8_t>(lumaOf<int>(p0 & 0xFF, (p0 >> 8) & 0xFF, (p0 >> 16) & 0xFF));
+            y1[x + dx] =
+                static_cast<uint8_t>(lumaOf<int>(p1 & 0xFF, (p1 >> 8) & 0xFF, (p1 >> 16) & 0xFF));
+        }
+        r = (r + 2) >> 2;
+        g = (g + 2) >> 2;
+        b = (b + 2) >> 2;
+        u[x / 2] = static_cast<uint8_t>(chromaUOf(r, g, b));
+        v[x / 2] = static_cast<uint8_t>(chromaVOf(r, g, b));
+    }
+}
+
+void shadeSpan(const SpanTriangle& tri, int y, int x_begin, int x_end, uint32_t color,
+               uint32_t* color_row, float* depth_row) {
+    const FloatVec lane_offsets = FloatVec().load(LANE_OFFSETS);
+    const FloatVec solid_color = reinterpret_f(IntVec(static_cast<int32_t>(color)));
+    for (int x{x_begin}; x < x_end; x += LANES) {
+        int n = x_end - x < LANES ? x_end - x : LANES;
+        FloatVec px = FloatVec(static_cast<float>(x)) + lane_offsets;
+        auto pixels = interpolate(tri, static_cast<float>(y), px);
+
+        // Adjust 1/w so the pixels that are closer to the camera have smaller values
+        FloatVec depth = 1.f - pixels.reciprocal_w;
+        FloatVec old_depth = FloatVec().load_partial(n, depth_row + x);
+        auto closer = depth < old_depth;
+        select(closer, depth, old_depth).store_partial(n, depth_row + x);
+        FloatVec old_color = reinterpret_f(IntVec().load_partial(n, color_row + x));
+        IntVec new_color = reinterpret_i(select(closer, solid_color, old_color));
+        new_color.store_partial(n, color_row + x);
+    }
+}
+
+void textureSpan(const SpanTriangle& tri, int y, int x_begin, int x_end, const uint32_t* texture,
+                 int texture_width, int texture_height, uint32_t* color_row, float* depth_row) {
+    const FloatVec lane_offsets = FloatVec().load(LANE_OFFSETS);
+    const Divisor_i width_divisor(texture_width);
+    const Divisor_i height_divisor(texture_height);
+    for (int x{x_begin}; x < x_end; x += LANES) {
+        int n = x_end - x < LANES ? x_end - x : LANES;
+        FloatVec px = FloatVec(static_cast<float>(x)) + lane_offsets;
+        auto pixels = interpolate(tri, static_cast<float>(y), px);
+
+        // perspective correct u and v, divide the interpolated u/w and v/w back by 1/w
+        FloatVec u = tri.au_w * pixels.alpha + tri.bu_w * pixels.beta + tri.cu_w * pixels.gamma;
+        FloatVec v = tri.av_w * pixels.alpha + tri.bv_w * pixels.beta + tri.cv_w * pixels.gamma;
+        u /= pixels.reciprocal_w;
+        v /= pixels.reciprocal_w;
+
+        // Map the UV coordinate to the full texture width and height
+        IntVec tex_x = abs(truncatei(u * static_cast<float>(texture_width)));
+        IntVec tex_y = abs(truncatei(v * static_cast<float>(texture_height)));
+        tex_x -= (tex_x / width_divisor) * texture_width;
+        tex_y -= (tex_y / height_divisor) * texture_height;
+
+        FloatVec depth = 1.f - pixels.reciprocal_w;
+        FloatVec old_depth = FloatVec().load_partial(n, depth_row + x);
+        // lanes past the span end are outside of the triangle and may hold any index
+        auto closer = (depth < old_depth) & (px < static_cast<float>(x_end));
+        // texels are only fetched for the pixels which are written, like the scalar path
+        IntVec texel_index = texture_width * tex_y + tex_x;
+        texel_index = reinterpret_i(select(closer, reinterpret_f(texel_index), FloatVec(0.f)));
+        FloatVec texel = reinterpret_f(lookup<INT_MAX>(texel_index, texture));
+
+        select(closer, depth, old_depth).store_partial(n, depth_row + x);
+        FloatVec old_color = reinterpret_f(IntVec().load_partial(n, color_row + x));
+        IntVec new_color = reinterpret_i(select(closer, texel, old_color));
+        new_color.store_partial(n, color_row + x);
+    }
+}
+}  // namespace
+
+const Kernels& getKernels() {
+#if INSTRSET >= 10
+    static constexpr const char* name = "AVX-512";
+#elif INSTRSET >= 8
+    static constexpr const char* name = "AVX2";
+#else
+    static constexpr const char* name = "SSE2";
+#endif
+    static const Kernels table{name,      transformVertices, transformQuantizedVertices,
+                               fillColor, fillDepth,         shadeSpan,
+                               textureSpan, convertToI420};
+    return table;
+}
+}  // namespace KERNEL_NAMESPACE
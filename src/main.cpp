@@ -1,22 +1,214 @@
 // STL
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <string_view>
 // Internal
+#include "renderFarm.hpp"
 #include "renderer.hpp"
 #ifdef TRACY_ENABLE
 #include <tracy/Tracy.hpp>
 #endif
 
+// renders the given number of frames into an offscreen color buffer and writes every frame as
+// <output_dir>/<model>_<frame>.<image_format>, unless the format is "none"
+static int renderOffscreen(Renderer& renderer, const std::string& obj_file_path, int frames,
+                           int width, int height, const std::filesystem::path& output_dir,
+                           const std::string& image_format) {
+    if (!renderer.initializeOffscreen(width, height) || !renderer.setupWindow(obj_file_path)) {
+        std::cerr << "Failed to setup offscreen rendering.\n";
+        renderer.destroyWindow();
+        return 2;
+    }
+    bool write_images = image_format != "none";
+    std::error_code ec;
+    if (write_images)
+        std::filesystem::create_directories(output_dir, ec);
+    auto stem = std::filesystem::path(obj_file_path).stem().string();
+    for (int frame{0}; frame < frames; frame++) {
+        renderer.update();
+        renderer.render(0.0);
+        if (!write_images)
+            continue;
+        char number[16];
+        std::snprintf(number, sizeof(number), "%04d", frame);
+        auto image_path = output_dir / (stem + "_" + number + "." + image_format);
+        if (!renderer.saveFrame(image_path.string())) {
+            renderer.destroyWindow();
+            return 4;
+        }
+    }
+    renderer.destroyWindow();
+    if (write_images)
+        std::cout << "Wrote " << frames << " frames to " << output_dir.string() << '\n';
+    return 0;
+}
+
+// the whole text has to be a number
+template <typename T>
+static bool parseNumber(std::string_view text, T& value) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--pipelined] [--optimize-mesh] [--quantize] [--asset-cache-mb <n>]"
+                 " [--stream-budget-mb <n>] [--fps <n>] [--dynamic-resolution]"
+                 " [--y4m <file | ->] [--stage-timings <file.csv | file.json | ->]"
+                 " <path_to_obj_model | path_to_rstream_mesh>\n";
+    std::cerr << "       " << program << " --convert-stream <path_to_obj_model>\n";
+    std::cerr << "       " << program
+              << " --headless <frames> [--size <w>x<h>] [--output-dir <dir>]"
+                 " [--image-format ppm|png|none] [--y4m <file | ->] [--render-mode <1-6>]"
+                 " [--rotate] [--stage-timings <file.csv | file.json | ->]"
+                 " <path_to_obj_model | path_to_rstream_mesh>\n";
+    std::cerr << "       " << program
+              << " --batch <job_file> [--jobs <n>] [--output-dir <dir>]"
+                 " [--image-format ppm|png]\n";
+}
+
 int main(int argc, char* argv[]) {
-    if (!argv[1]) {
+    std::string obj_file_path;
+    bool pipelined{false};
+    size_t asset_cache_budget{DEFAULT_ASSET_CACHE_BUDGET};
+    size_t streaming_budget{DEFAULT_STREAMING_BUDGET};
+    bool convert_stream{false};
+    bool optimize_mesh{false};
+    bool quantize{false};
+    int headless_frames{0};
+    int width{1280};
+    int height{720};
+    std::filesystem::path output_dir{"."};
+    std::string image_format{"ppm"};
+    int render_mode{1};
+    bool rotate{false};
+    std::string job_file_path;
+    unsigned batch_threads{0};
+    std::string video_path;
+    double fps_limit{60.0};
+    bool dynamic_resolution{false};
+    std::string stage_timings_path;
+    for (int i{1}; i < argc; i++) {
+        std::string_view arg = argv[i];
+        bool valid{true};  // false once the value of arg is not a number
+        if (arg == "--pipelined") {
+            pipelined = true;
+        } else if (arg == "--asset-cache-mb" && i + 1 < argc) {
+            valid = parseNumber(argv[++i], asset_cache_budget);
+            asset_cache_budget <<= 20;
+        } else if (arg == "--stream-budget-mb" && i + 1 < argc) {
+            valid = parseNumber(argv[++i], streaming_budget);
+            streaming_budget <<= 20;
+        } else if (arg == "--convert-stream") {
+            convert_stream = true;
+        } else if (arg == "--optimize-mesh") {
+            optimize_mesh = true;
+        } else if (arg == "--quantize") {
+            quantize = true;
+        } else if (arg == "--headless" && i + 1 < argc) {
+            valid = parseNumber(argv[++i], headless_frames);
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                std::cerr << "--size expects <width>x<height>\n";
+                return 1;
+            }
+        } else if (arg == "--output-dir" && i + 1 < argc) {
+            output_dir = argv[++i];
+        } else if (arg == "--image-format" && i + 1 < argc) {
+            image_format = argv[++i];
+        } else if (arg == "--render-mode" && i + 1 < argc) {
+            valid = parseNumber(argv[++i], render_mode);
+        } else if (arg == "--rotate") {
+            rotate = true;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            job_file_path = argv[++i];
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            valid = parseNumber(argv[++i], batch_threads);
+        } else if (arg == "--y4m" && i + 1 < argc) {
+            video_path = argv[++i];
+        } else if (arg == "--fps" && i + 1 < argc) {
+            valid = parseNumber(argv[++i], fps_limit);
+        } else if (arg == "--dynamic-resolution") {
+            dynamic_resolution = true;
+        } else if (arg == "--stage-timings" && i + 1 < argc) {
+            stage_timings_path = argv[++i];
+        } else if (arg.starts_with("--")) {
+            std::cerr << "Unknown option or missing value: " << arg << '\n';
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            obj_file_path = arg;
+        }
+        if (!valid) {
+            std::cerr << arg << " expects a number, got " << argv[i] << '\n';
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    // the video owns stdout, the log goes to stderr
+    if (video_path == "-")
+        std::cout.rdbuf(std::cerr.rdbuf());
+    if (!job_file_path.empty()) {
+        RenderFarm farm;
+        if (!farm.loadJobFile(job_file_path))
+            return 1;
+        std::error_code ec;
+        std::filesystem::create_directories(output_dir, ec);
+        bool succeeded = farm.run(output_dir, image_format, batch_threads);
+        auto report_path = output_dir / "timing.csv";
+        farm.writeReport(report_path);
+        auto failed = std::count_if(farm.results().begin(), farm.results().end(),
+                                    [](const RenderJobResult& result) { return !result.succeeded; });
+        std::cout << "Rendered " << farm.jobs().size() - failed << " of " << farm.jobs().size()
+                  << " jobs, timings in " << report_path.string() << '\n';
+        return succeeded ? 0 : 4;
+    }
+    if (obj_file_path.empty()) {
         std::cerr << "Enter a path to .obj file.\n";
+        printUsage(argv[0]);
         return 1;
     }
+    if (render_mode < 1 || render_mode > 6) {
+        std::cerr << "--render-mode expects 1 to 6\n";
+        return 1;
+    }
+    if (convert_stream) {
+        auto stream_file_path =
+            std::filesystem::path(obj_file_path).replace_extension(".rstream").string();
+        if (!Renderer::convertToStreamFile(obj_file_path, stream_file_path)) {
+            std::cerr << "Failed to convert " << obj_file_path << '\n';
+            return 1;
+        }
+        std::cout << "Wrote " << stream_file_path << '\n';
+        return 0;
+    }
     {
         Timer timer;
         Renderer renderer;
+        renderer.setPipelined(pipelined);
+        renderer.setAssetCacheBudget(asset_cache_budget);
+        renderer.setStreamingBudget(streaming_budget);
+        renderer.setOptimizeMeshes(optimize_mesh);
+        renderer.setQuantizeMeshes(quantize);
+        renderer.setRenderMode(static_cast<RenderMode>(render_mode - 1));
+        renderer.setRotateModel(rotate);
+        renderer.setVideoOutput(video_path);
+        renderer.setFrameRateLimit(fps_limit);
+        renderer.setDynamicResolution(dynamic_resolution);
+        renderer.setStageTimingsOutput(stage_timings_path);
+        if (headless_frames > 0) {
+            // frames are written as soon as they are rendered, there is no extra frame of latency
+            renderer.setPipelined(false);
+            return renderOffscreen(renderer, obj_file_path, headless_frames, width, height,
+                                   output_dir, image_format);
+        }
         if (renderer.initializeWindow(false)) {
-            if (renderer.setupWindow(argv[1])) {
+            if (renderer.setupWindow(obj_file_path)) {
                 // Game Loop
                 while (renderer.getWindowState()) {
                     #ifdef TRACY_ENABLE
@@ -0,0 +1,134 @@
+//STL
+#include <algorithm>
+#include <utility>
+//INTERNAL
+#include <mappedFile.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path, Access access) {
+    DWORD flags = access == Access::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return;
+    }
+    _fileHandle = file;
+    _open = true;
+    if (size.QuadPart == 0)
+        return;  // empty files can not be mapped
+
+    _mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mappingHandle)
+        _data = static_cast<const char*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!_data) {
+        close();
+        return;
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+}
+
+void MappedFile::release(size_t offset, size_t size) const {
+    // only removes the pages from the working set, the mapping itself stays valid
+    if (_data && offset < _size)
+        VirtualUnlock(const_cast<char*>(_data) + offset, std::min(size, _size - offset));
+}
+
+void MappedFile::close() {
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mappingHandle)
+        CloseHandle(_mappingHandle);
+    if (_fileHandle)
+        CloseHandle(_fileHandle);
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+    _mappingHandle = nullptr;
+    _fileHandle = nullptr;
+}
+#else
+MappedFile::MappedFile(const std::string& path, Access access) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return;
+    }
+    _open = true;
+    if (info.st_size > 0) {
+        auto size = static_cast<size_t>(info.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            _open = false;
+        } else {
+            // parsers walk the file front to back and get aggressive read-ahead, streamed chunks
+            // are read where the camera looks and get none
+            madvise(data, size, access == Access::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+            _data = static_cast<const char*>(data);
+            _size = size;
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+void MappedFile::release(size_t offset, size_t size) const {
+    if (!_data || offset >= _size)
+        return;
+    // madvise needs a page aligned start, only whole pages inside the range are dropped
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = (offset + page_size - 1) / page_size * page_size;
+    size_t end = std::min(offset + size, _size);
+    if (end != _size)
+        end = end / page_size * page_size;
+    if (begin < end)
+        madvise(const_cast<char*>(_data) + begin, end - begin, MADV_DONTNEED);
+}
+
+void MappedFile::close() {
+    if (_data)
+        munmap(const_cast<char*>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+}
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+        _open = std::exchange(other._open, false);
+#ifdef _WIN32
+        _fileHandle = std::exchange(other._fileHandle, nullptr);
+        _mappingHandle = std::exchange(other._mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
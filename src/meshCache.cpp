@@ -0,0 +1,176 @@
+//STL
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+//INTERNAL
+#include <mappedFile.hpp>
+#include <meshCache.hpp>
+
+namespace {
+constexpr std::array<char, 4> MESH_CACHE_MAGIC{'R', 'M', 'S', 'H'};
+
+// followed by the mesh payload of numVertices and numFaces
+struct MeshCacheHeader {
+    std::array<char, 4> magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t payloadHash;
+    uint32_t numVertices;
+    uint32_t numFaces;
+    uint32_t flags;  // MESH_CACHE_* options the payload was produced with
+    uint32_t reserved;
+};
+static_assert(sizeof(MeshCacheHeader) == 48, "header layout is part of the file format");
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+}  // namespace
+
+uint64_t fnv1aHash(const void* data, size_t size) {
+    auto bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash{FNV_OFFSET_BASIS};
+    for (size_t i{0}; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+bool sourceFileStamp(const std::string& source_path, uint64_t& size, int64_t& time) {
+    std::error_code ec;
+    size = std::filesystem::file_size(source_path, ec);
+    if (ec)
+        return false;
+    time = std::filesystem::last_write_time(source_path, ec).time_since_epoch().count();
+    return !ec;
+}
+
+bool writeSidecarFile(const std::string& path, const void* header, size_t header_size,
+                      const void* payload, size_t payload_size) {
+    // written under a unique name and renamed, so a concurrent reader never maps a partial file
+    auto temp_path = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+    std::error_code ec;
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(static_cast<const char*>(header), header_size);
+        out.write(static_cast<const char*>(payload), payload_size);
+        if (!out) {
+            out.close();
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+static_assert(sizeof(Eigen::Vector3f) == 3 * sizeof(float), "positions are copied as one block");
+
+size_t meshPayloadSize(size_t num_vertices, size_t num_faces) {
+    return num_vertices * 3 * sizeof(float) + num_faces * 3 * sizeof(int32_t) +
+           num_faces * 6 * sizeof(float);
+}
+
+void packMeshPayload(const std::vector<Eigen::Vector3f>& vertices, const std::vector<Face>& faces,
+                     std::vector<char>& payload) {
+    payload.resize(meshPayloadSize(vertices.size(), faces.size()));
+    char* positions = payload.data();
+    char* indices = positions + vertices.size() * 3 * sizeof(float);
+    char* uvs = indices + faces.size() * 3 * sizeof(int32_t);
+    if (!vertices.empty())
+        std::memcpy(positions, vertices.data()->data(), vertices.size() * 3 * sizeof(float));
+    for (size_t i{0}; i < faces.size(); i++) {
+        const auto& face = faces[i];
+        std::array<int32_t, 3> corners{face.a, face.b, face.c};
+        std::array<float, 6> corner_uvs{face.a_uv.x(), face.a_uv.y(), face.b_uv.x(),
+                                        face.b_uv.y(), face.c_uv.x(), face.c_uv.y()};
+        std::memcpy(indices + i * sizeof(corners), corners.data(), sizeof(corners));
+        std::memcpy(uvs + i * sizeof(corner_uvs), corner_uvs.data(), sizeof(corner_uvs));
+    }
+}
+
+void unpackMeshPayload(const char* payload, size_t num_vertices, size_t num_faces,
+                       std::vector<Eigen::Vector3f>& vertices, std::vector<Face>& faces) {
+    vertices.resize(num_vertices);
+    if (num_vertices > 0)
+        std::memcpy(vertices.data()->data(), payload, num_vertices * 3 * sizeof(float));
+    const char* indices = payload + num_vertices * 3 * sizeof(float);
+    const char* uvs = indices + num_faces * 3 * sizeof(int32_t);
+    faces.resize(num_faces);
+    for (size_t i{0}; i < faces.size(); i++) {
+        Face face{};
+        std::array<int32_t, 3> corners;
+        std::array<float, 6> corner_uvs;
+        std::memcpy(corners.data(), indices + i * sizeof(corners), sizeof(corners));
+        std::memcpy(corner_uvs.data(), uvs + i * sizeof(corner_uvs), sizeof(corner_uvs));
+        face.a = corners[0];
+        face.b = corners[1];
+        face.c = corners[2];
+        face.a_uv = {corner_uvs[0], corner_uvs[1]};
+        face.b_uv = {corner_uvs[2], corner_uvs[3]};
+        face.c_uv = {corner_uvs[4], corner_uvs[5]};
+        face.color = 0xFFFFFFFF;
+        faces[i] = face;
+    }
+}
+
+std::string meshCachePath(const std::string& obj_path) {
+    return std::filesystem::path(obj_path).replace_extension(".rmesh").string();
+}
+
+bool loadMeshCache(const std::string& obj_path, uint32_t flags,
+                   std::vector<Eigen::Vector3f>& vertices, std::vector<Face>& faces) {
+    uint64_t source_size;
+    int64_t source_time;
+    if (!sourceFileStamp(obj_path, source_size, source_time))
+        return false;
+    MappedFile file(meshCachePath(obj_path));
+    if (!file.isOpen() || file.size() < sizeof(MeshCacheHeader))
+        return false;
+
+    MeshCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION ||
+        header.sourceSize != source_size || header.sourceTime != source_time ||
+        header.flags != flags)
+        return false;
+    const char* payload = file.data() + sizeof(header);
+    size_t payload_size = meshPayloadSize(header.numVertices, header.numFaces);
+    if (file.size() != sizeof(header) + payload_size ||
+        fnv1aHash(payload, payload_size) != header.payloadHash)
+        return false;
+
+    unpackMeshPayload(payload, header.numVertices, header.numFaces, vertices, faces);
+    return true;
+}
+
+bool saveMeshCache(const std::string& obj_path, uint32_t flags,
+                   const std::vector<Eigen::Vector3f>& vertices, const std::vector<Face>& faces) {
+    MeshCacheHeader header{.magic = MESH_CACHE_MAGIC,
+                           .version = MESH_CACHE_VERSION,
+                           .numVertices = static_cast<uint32_t>(vertices.size()),
+                           .numFaces = static_cast<uint32_t>(faces.size()),
+                           .flags = flags,
+                           .reserved = 0};
+    if (!sourceFileStamp(obj_path, header.sourceSize, header.sourceTime))
+        return false;
+
+    std::vector<char> payload;
+    packMeshPayload(vertices, faces, payload);
+    header.payloadHash = fnv1aHash(payload.data(), payload.size());
+
+    auto cache_path = meshCachePath(obj_path);
+    if (!writeSidecarFile(cache_path, &header, sizeof(header), payload.data(), payload.size())) {
+        std::cerr << "Failed to write mesh cache: " << cache_path << '\n';
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,175 @@
+//STL
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+//INTERNAL
+#include <meshOptimizer.hpp>
+
+namespace {
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_FACE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+std::array<int, 3> corners(const Face& face) {
+    return {face.a, face.b, face.c};
+}
+
+// vertices in the cache score higher (the three of the last face a fixed amount so the next face
+// does not reuse all of them), vertices with few faces left are boosted so they are finished
+// instead of leaving single faces behind
+float vertexScore(int cache_position, int remaining_faces) {
+    if (remaining_faces == 0)
+        return -1.f;
+    float score{0.f};
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            score = LAST_FACE_SCORE;
+        } else {
+            float scale = 1.f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.f - (cache_position - 3) * scale, CACHE_DECAY_POWER);
+        }
+    }
+    return score + VALENCE_BOOST_SCALE *
+                       std::pow(static_cast<float>(remaining_faces), -VALENCE_BOOST_POWER);
+}
+}  // namespace
+
+float averageCacheMissRatio(const std::vector<Face>& faces, size_t num_vertices,
+                            size_t cache_size) {
+    if (faces.empty())
+        return 0.f;
+    // miss count at the time the vertex entered the FIFO, 0 if it never did
+    std::vector<size_t> entered(num_vertices, 0);
+    size_t misses{0};
+    for (const auto& face : faces) {
+        for (int vertex : corners(face)) {
+            if (entered[vertex] == 0 || misses - entered[vertex] >= cache_size)
+                entered[vertex] = ++misses;
+        }
+    }
+    return static_cast<float>(misses) / faces.size();
+}
+
+void optimizeVertexCache(std::vector<Face>& faces, size_t num_vertices) {
+    auto num_faces = faces.size();
+    if (num_faces == 0)
+        return;
+
+    // faces of every vertex, the ones not emitted yet are kept at the front of each range
+    std::vector<size_t> offsets(num_vertices + 1, 0);
+    for (const auto& face : faces) {
+        for (int vertex : corners(face))
+            offsets[vertex + 1]++;
+    }
+    for (size_t i{0}; i < num_vertices; i++)
+        offsets[i + 1] += offsets[i];
+    std::vector<uint32_t> vertex_faces(offsets.back());
+    std::vector<int> remaining(num_vertices, 0);
+    for (uint32_t f{0}; f < num_faces; f++) {
+        for (int vertex : corners(faces[f]))
+            vertex_faces[offsets[vertex] + remaining[vertex]++] = f;
+    }
+
+    std::vector<int> cache_position(num_vertices, -1);
+    std::vector<float> vertex_scores(num_vertices);
+    for (size_t v{0}; v < num_vertices; v++)
+        vertex_scores[v] = vertexScore(-1, remaining[v]);
+    std::vector<float> face_scores(num_faces);
+    for (size_t f{0}; f < num_faces; f++) {
+        for (int vertex : corners(faces[f]))
+            face_scores[f] += vertex_scores[vertex];
+    }
+
+    auto updateVertex = [&](int vertex) {
+        float score = vertexScore(cache_position[vertex], remaining[vertex]);
+        float delta = score - vertex_scores[vertex];
+        vertex_scores[vertex] = score;
+        for (int i{0}; i < remaining[vertex]; i++)
+            face_scores[vertex_faces[offsets[vertex] + i]] += delta;
+    };
+
+    std::vector<Face> result;
+    result.reserve(num_faces);
+    std::vector<bool> emitted(num_faces, false);
+    std::vector<int> cache;
+    std::vector<int> next_cache;
+    size_t best{0};
+    for (size_t f{1}; f < num_faces; f++) {
+        if (face_scores[f] > face_scores[best])
+            best = f;
+    }
+    size_t scan{0};  // faces before it are all emitted
+    while (true) {
+        emitted[best] = true;
+        result.push_back(faces[best]);
+
+        // the corners of the face move to the front of the LRU cache
+        auto face_corners = corners(faces[best]);
+        next_cache.assign(face_corners.begin(), face_corners.end());
+        for (int vertex : cache) {
+            if (vertex != face_corners[0] && vertex != face_corners[1] &&
+                vertex != face_corners[2])
+                next_cache.push_back(vertex);
+        }
+        for (int vertex : face_corners) {
+            auto begin = vertex_faces.begin() + offsets[vertex];
+            auto last = begin + --remaining[vertex];
+            std::iter_swap(std::find(begin, last + 1, static_cast<uint32_t>(best)), last);
+        }
+        for (size_t i{FORSYTH_CACHE_SIZE}; i < next_cache.size(); i++) {
+            cache_position[next_cache[i]] = -1;
+            updateVertex(next_cache[i]);
+        }
+        if (next_cache.size() > FORSYTH_CACHE_SIZE)
+            next_cache.resize(FORSYTH_CACHE_SIZE);
+        for (size_t i{0}; i < next_cache.size(); i++) {
+            cache_position[next_cache[i]] = static_cast<int>(i);
+            updateVertex(next_cache[i]);
+        }
+        std::swap(cache, next_cache);
+
+        // the next face is the best one using a cached vertex, a new start when there is none
+        float best_score = -std::numeric_limits<float>::max();
+        bool found{false};
+        for (int vertex : cache) {
+            for (int i{0}; i < remaining[vertex]; i++) {
+                auto f = vertex_faces[offsets[vertex] + i];
+                if (face_scores[f] > best_score) {
+                    best_score = face_scores[f];
+                    best = f;
+                    found = true;
+                }
+            }
+        }
+        if (!found) {
+            while (scan < num_faces && emitted[scan])
+                scan++;
+            if (scan == num_faces)
+                break;
+            best = scan;
+        }
+    }
+    faces = std::move(result);
+}
+
+void reorderVerticesByFirstUse(std::vector<Eigen::Vector3f>& vertices, std::vector<Face>& faces) {
+    std::vector<int> remap(vertices.size(), -1);
+    std::vector<Eigen::Vector3f> reordered;
+    reordered.reserve(vertices.size());
+    for (auto& face : faces) {
+        for (int* vertex : {&face.a, &face.b, &face.c}) {
+            if (remap[*vertex] < 0) {
+                remap[*vertex] = static_cast<int>(reordered.size());
+                reordered.push_back(vertices[*vertex]);
+            }
+            *vertex = remap[*vertex];
+        }
+    }
+    for (size_t v{0}; v < vertices.size(); v++) {
+        if (remap[v] < 0)
+            reordered.push_back(vertices[v]);
+    }
+    vertices = std::move(reordered);
+}
@@ -0,0 +1,66 @@
+//STL
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+//INTERNAL
+#include <meshQuantization.hpp>
+
+namespace {
+uint16_t quantizeUV(float value, float min, float scale) {
+    if (scale <= 0.f)
+        return 0;
+    return static_cast<uint16_t>(std::clamp(std::lround((value - min) / scale), 0l, 65535l));
+}
+}  // namespace
+
+void quantizeModel(ModelData& model) {
+    if (model.isQuantized())
+        return;
+
+    float max_abs{0.f};
+    for (const auto& vertex : model.vertices) {
+        max_abs = std::max(max_abs, vertex.cwiseAbs().maxCoeff());
+    }
+    model.positionScale = max_abs > 0.f ? max_abs / INT16_MAX : 1.f;
+    model.quantizedVertices.resize(model.vertices.size());
+    for (size_t i{0}; i < model.vertices.size(); i++) {
+        auto quantize = [&](float value) {
+            return static_cast<int16_t>(std::clamp(std::lround(value / model.positionScale),
+                                                   long{-INT16_MAX}, long{INT16_MAX}));
+        };
+        const auto& vertex = model.vertices[i];
+        model.quantizedVertices[i] = {quantize(vertex.x()), quantize(vertex.y()),
+                                      quantize(vertex.z())};
+    }
+
+    Eigen::Vector2f min{FLT_MAX, FLT_MAX};
+    Eigen::Vector2f max{-FLT_MAX, -FLT_MAX};
+    for (const auto& face : model.faces) {
+        for (const auto* uv : {&face.a_uv, &face.b_uv, &face.c_uv}) {
+            min = min.cwiseMin(*uv);
+            max = max.cwiseMax(*uv);
+        }
+    }
+    if (model.faces.empty())
+        min = max = Eigen::Vector2f::Zero();
+    model.uvMin = min;
+    model.uvScale = (max - min) / 65535.f;
+    model.quantizedFaces.resize(model.faces.size());
+    for (size_t i{0}; i < model.faces.size(); i++) {
+        const auto& face = model.faces[i];
+        auto& quantized = model.quantizedFaces[i];
+        quantized.a = face.a;
+        quantized.b = face.b;
+        quantized.c = face.c;
+        int corner{0};
+        for (const auto* uv : {&face.a_uv, &face.b_uv, &face.c_uv}) {
+            quantized.uvs[corner++] = quantizeUV(uv->x(), min.x(), model.uvScale.x());
+            quantized.uvs[corner++] = quantizeUV(uv->y(), min.y(), model.uvScale.y());
+        }
+        quantized.color = face.color;
+    }
+
+    // the float arrays are not used anymore, release their memory
+    std::vector<Eigen::Vector3f>().swap(model.vertices);
+    std::vector<Face>().swap(model.faces);
+}
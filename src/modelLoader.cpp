@@ -0,0 +1,58 @@
+//STL
+#include <memory>
+//INTERNAL
+#include <modelLoader.hpp>
+#include <profiling.hpp>
+
+ModelLoader::ModelLoader(LoadFunc load) : _load(std::move(load)) {
+    _thread = std::thread([this] { loaderLoop(); });
+}
+
+ModelLoader::~ModelLoader() {
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _wakeUp.notify_one();
+    _thread.join();
+}
+
+void ModelLoader::request(const std::vector<std::string>& paths) {
+    _cache.setPinned(paths);
+    {
+        std::lock_guard lock(_mutex);
+        _queue.clear();
+        for (const auto& path : paths) {
+            if (path != _loading && !_cache.contains(path))
+                _queue.push_back(path);
+        }
+    }
+    _wakeUp.notify_one();
+}
+
+void ModelLoader::waitUntilIdle() {
+    std::unique_lock lock(_mutex);
+    _idle.wait(lock, [this] { return _queue.empty() && _loading.empty(); });
+}
+
+void ModelLoader::loaderLoop() {
+    PROFILE_THREAD_NAME("Model loader");
+    std::unique_lock lock(_mutex);
+    while (true) {
+        _wakeUp.wait(lock, [this] { return _stop || !_queue.empty(); });
+        if (_stop)
+            return;
+        _loading = std::move(_queue.front());
+        _queue.pop_front();
+
+        lock.unlock();
+        auto model = std::make_shared<ModelData>();
+        _load(_loading, *model);
+        _cache.put(_loading, std::move(model));
+        lock.lock();
+
+        _loading.clear();
+        if (_queue.empty())
+            _idle.notify_all();
+    }
+}
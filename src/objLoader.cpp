@@ -0,0 +1,306 @@
+//STL
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+//INTERNAL
+#include <jobSystem.hpp>
+#include <mappedFile.hpp>
+#include <objLoader.hpp>
+
+namespace {
+enum class Record { VERTEX, TEXTURE_COORD, FACE, OTHER };
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+const char* skipBlanks(const char* p, const char* end) {
+    while (p != end && isBlank(*p))
+        ++p;
+    return p;
+}
+
+Record recordType(const char* line, const char* end) {
+    auto length = end - line;
+    if (length >= 2 && line[0] == 'v' && isBlank(line[1]))
+        return Record::VERTEX;
+    if (length >= 3 && line[0] == 'v' && line[1] == 't' && isBlank(line[2]))
+        return Record::TEXTURE_COORD;
+    if (length >= 2 && line[0] == 'f' && isBlank(line[1]))
+        return Record::FACE;
+    return Record::OTHER;
+}
+
+// calls func(line_begin, line_end) for every line, line_end points at the '\n' or the text end
+template <typename Func>
+void forEachLine(std::string_view text, Func&& func) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        auto eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = eol ? eol : end;
+        func(p, line_end);
+        p = line_end + 1;
+    }
+}
+
+bool parseFloat(const char*& p, const char* end, float& value) {
+    p = skipBlanks(p, end);
+    if (p != end && *p == '+')
+        ++p;  // from_chars does not take a leading plus
+    auto [next, ec] = std::from_chars(p, end, value);
+    if (ec != std::errc{})
+        return false;
+    p = next;
+    return true;
+}
+
+bool parseIndex(const char*& p, const char* end, int& value) {
+    if (p != end && *p == '+')
+        ++p;
+    auto [next, ec] = std::from_chars(p, end, value);
+    if (ec != std::errc{})
+        return false;
+    p = next;
+    return true;
+}
+
+// one face corner v, v/vt, v//vn or v/vt/vn, uv is 0 if the corner has no texture coordinate
+bool parseCorner(const char*& p, const char* end, int& vertex, int& uv) {
+    p = skipBlanks(p, end);
+    if (!parseIndex(p, end, vertex))
+        return false;
+    uv = 0;
+    if (p != end && *p == '/') {
+        ++p;
+        if (p != end && *p != '/' && !parseIndex(p, end, uv))
+            return false;
+        if (p != end && *p == '/') {
+            ++p;
+            int normal;  // face normals are computed from the vertices
+            if (!parseIndex(p, end, normal))
+                return false;
+        }
+    }
+    return p == end || isBlank(*p) || *p == '\r';
+}
+
+// OBJ indices are 1-based, negative ones count back from the last record read so far
+bool resolveIndex(int index, size_t count, int& resolved) {
+    if (index > 0 && static_cast<size_t>(index) <= count) {
+        resolved = index - 1;
+        return true;
+    }
+    if (index < 0 && static_cast<size_t>(-static_cast<int64_t>(index)) <= count) {
+        resolved = static_cast<int>(count) + index;
+        return true;
+    }
+    return false;
+}
+
+// face as written in the file, the indices are resolved once the records of all previous chunks
+// are counted
+struct RawFace {
+    std::array<int, 3> vertices;
+    std::array<int, 3> uvs;  // 0 if the corner has no texture coordinate
+    size_t verticesBefore;  // records of the own chunk in front of the face line
+    size_t uvsBefore;
+    std::string_view line;
+};
+
+struct ParseError {
+    const char* message;
+    std::string_view line;
+};
+
+// line aligned piece of the file parsed by one job
+struct ObjChunk {
+    std::string_view text;
+    std::vector<Eigen::Vector3f> vertices;
+    std::vector<Eigen::Vector2f> textureCoords;
+    std::vector<RawFace> rawFaces;
+    std::vector<Face> faces;
+    std::vector<ParseError> errors;
+    // position of the chunk records in the merged arrays (prefix sums over the chunks before)
+    size_t vertexOffset{0};
+    size_t uvOffset{0};
+    size_t faceOffset{0};
+};
+
+std::vector<ObjChunk> splitIntoChunks(std::string_view text) {
+    std::vector<ObjChunk> chunks;
+    size_t begin{0};
+    while (begin < text.size()) {
+        size_t end = std::min(begin + OBJ_CHUNK_SIZE, text.size());
+        // a record never spans two chunks
+        if (end < text.size()) {
+            auto eol = text.find('\n', end);
+            end = eol == std::string_view::npos ? text.size() : eol + 1;
+        }
+        chunks.push_back({.text = text.substr(begin, end - begin)});
+        begin = end;
+    }
+    return chunks;
+}
+
+void parseChunk(ObjChunk& chunk) {
+    // count the records first so every vector is allocated once
+    size_t num_vertices{0};
+    size_t num_texture_coords{0};
+    size_t num_faces{0};
+    forEachLine(chunk.text, [&](const char* line, const char* line_end) {
+        switch (recordType(line, line_end)) {
+            case Record::VERTEX: num_vertices++; break;
+            case Record::TEXTURE_COORD: num_texture_coords++; break;
+            case Record::FACE: num_faces++; break;
+            case Record::OTHER: break;
+        }
+    });
+    chunk.vertices.reserve(num_vertices);
+    chunk.textureCoords.reserve(num_texture_coords);
+    chunk.rawFaces.reserve(num_faces);
+
+    forEachLine(chunk.text, [&](const char* line, const char* line_end) {
+        std::string_view line_text(line, line_end - line);
+        switch (recordType(line, line_end)) {
+            case Record::VERTEX: {
+                const char* p = line + 1;
+                Eigen::Vector3f vertex;
+                if (!parseFloat(p, line_end, vertex.x()) || !parseFloat(p, line_end, vertex.y()) ||
+                    !parseFloat(p, line_end, vertex.z())) {
+                    chunk.errors.push_back({"Error parsing vertex line: ", line_text});
+                    return;
+                }
+                chunk.vertices.push_back(vertex);
+                break;
+            }
+            case Record::TEXTURE_COORD: {
+                const char* p = line + 2;
+                Eigen::Vector2f textureCoord;
+                if (!parseFloat(p, line_end, textureCoord.x()) ||
+                    !parseFloat(p, line_end, textureCoord.y())) {
+                    chunk.errors.push_back({"Error parsing texture coordinates line: ", line_text});
+                    return;
+                }
+                chunk.textureCoords.push_back(textureCoord);
+                break;
+            }
+            case Record::FACE: {
+                const char* p = line + 1;
+                RawFace face{.verticesBefore = chunk.vertices.size(),
+                             .uvsBefore = chunk.textureCoords.size(),
+                             .line = line_text};
+                for (int i{0}; i < 3; i++) {
+                    if (!parseCorner(p, line_end, face.vertices[i], face.uvs[i])) {
+                        chunk.errors.push_back({"Error parsing face line: ", line_text});
+                        return;
+                    }
+                }
+                chunk.rawFaces.push_back(face);
+                break;
+            }
+            case Record::OTHER: break;
+        }
+    });
+}
+
+void resolveFaces(ObjChunk& chunk, const std::vector<Eigen::Vector2f>& textureCoords) {
+    chunk.faces.reserve(chunk.rawFaces.size());
+    for (const auto& raw : chunk.rawFaces) {
+        size_t num_vertices = chunk.vertexOffset + raw.verticesBefore;
+        size_t num_texture_coords = chunk.uvOffset + raw.uvsBefore;
+        Face face{};
+        std::array<int*, 3> corner_vertices{&face.a, &face.b, &face.c};
+        std::array<Eigen::Vector2f*, 3> corner_uvs{&face.a_uv, &face.b_uv, &face.c_uv};
+        bool valid{true};
+        for (int i{0}; i < 3; i++) {
+            int uv_index{0};
+            valid = resolveIndex(raw.vertices[i], num_vertices, *corner_vertices[i]) &&
+                    (raw.uvs[i] == 0 || resolveIndex(raw.uvs[i], num_texture_coords, uv_index));
+            // uv_index is only set when both indices resolved
+            if (!valid)
+                break;
+            if (raw.uvs[i] != 0)
+                *corner_uvs[i] = textureCoords[uv_index];
+            else
+                corner_uvs[i]->setZero();
+        }
+        if (!valid) {
+            chunk.errors.push_back({"Error parsing face line: ", raw.line});
+            continue;
+        }
+        face.color = 0xFFFFFFFF;
+        chunk.faces.push_back(face);
+    }
+    chunk.rawFaces = {};
+}
+}  // namespace
+
+void parseObj(std::string_view text, std::vector<Eigen::Vector3f>& vertices,
+              std::vector<Face>& faces) {
+    auto chunks = splitIntoChunks(text);
+    auto& jobSystem = JobSystem::instance();
+    auto forEachChunk = [&](auto&& func) {
+        jobSystem.parallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+            for (auto i{begin}; i < end; i++) {
+                func(chunks[i]);
+            }
+        });
+    };
+
+    forEachChunk([](ObjChunk& chunk) { parseChunk(chunk); });
+
+    size_t num_vertices{0};
+    size_t num_texture_coords{0};
+    for (auto& chunk : chunks) {
+        chunk.vertexOffset = num_vertices;
+        chunk.uvOffset = num_texture_coords;
+        num_vertices += chunk.vertices.size();
+        num_texture_coords += chunk.textureCoords.size();
+    }
+    vertices.resize(num_vertices);
+    std::vector<Eigen::Vector2f> textureCoords(num_texture_coords);
+    forEachChunk([&](ObjChunk& chunk) {
+        std::copy(chunk.vertices.begin(), chunk.vertices.end(),
+                  vertices.begin() + chunk.vertexOffset);
+        std::copy(chunk.textureCoords.begin(), chunk.textureCoords.end(),
+                  textureCoords.begin() + chunk.uvOffset);
+        chunk.vertices = {};
+        chunk.textureCoords = {};
+    });
+
+    // faces can use the texture coordinates of any previous chunk, so they are resolved after
+    // all of them are merged
+    forEachChunk([&](ObjChunk& chunk) { resolveFaces(chunk, textureCoords); });
+
+    size_t num_faces{0};
+    for (auto& chunk : chunks) {
+        chunk.faceOffset = num_faces;
+        num_faces += chunk.faces.size();
+    }
+    faces.resize(num_faces);
+    forEachChunk([&](ObjChunk& chunk) {
+        std::copy(chunk.faces.begin(), chunk.faces.end(), faces.begin() + chunk.faceOffset);
+    });
+
+    // report in file order
+    for (auto& chunk : chunks) {
+        std::sort(chunk.errors.begin(), chunk.errors.end(),
+                  [](const auto& a, const auto& b) { return a.line.data() < b.line.data(); });
+        for (const auto& error : chunk.errors) {
+            std::cerr << error.message << error.line << '\n';
+        }
+    }
+}
+
+bool loadObj(const std::string& path, std::vector<Eigen::Vector3f>& vertices,
+             std::vector<Face>& faces) {
+    MappedFile file(path);
+    if (!file.isOpen())
+        return false;
+    parseObj(file.view(), vertices, faces);
+    return true;
+}
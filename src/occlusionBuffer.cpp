@@ -0,0 +1,116 @@
+//STL
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+//INTERNAL
+#include <occlusionBuffer.hpp>
+//3RD-PARTY
+#include "version2/vectorclass.h"
+
+OcclusionBuffer::OcclusionBuffer() : _depth(OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT) {
+    clear();
+}
+
+void OcclusionBuffer::setScreenSize(int width, int height) {
+    _scaleX = static_cast<float>(OCCLUSION_BUFFER_WIDTH) / width;
+    _scaleY = static_cast<float>(OCCLUSION_BUFFER_HEIGHT) / height;
+}
+
+void OcclusionBuffer::clear() {
+    std::fill(std::begin(_depth), std::end(_depth), FLT_MAX);
+}
+
+float OcclusionBuffer::area(const Triangle& tri) const {
+    const auto& [a, b, c] = tri.points;
+    float ab_x = (b.x() - a.x()) * _scaleX;
+    float ab_y = (b.y() - a.y()) * _scaleY;
+    float ac_x = (c.x() - a.x()) * _scaleX;
+    float ac_y = (c.y() - a.y()) * _scaleY;
+    return std::abs(ab_x * ac_y - ab_y * ac_x) * 0.5f;
+}
+
+void OcclusionBuffer::rasterizeOccluder(const Triangle& tri) {
+    std::array<Eigen::Vector2f, 3> p;
+    for (int i{0}; i < 3; i++) {
+        p[i] = {tri.points[i].x() * _scaleX, tri.points[i].y() * _scaleY};
+    }
+
+    // make the winding consistent so the edge functions are positive inside the triangle
+    float area = (p[1].x() - p[0].x()) * (p[2].y() - p[0].y()) -
+                 (p[1].y() - p[0].y()) * (p[2].x() - p[0].x());
+    if (std::abs(area) < 1.f)
+        return;  // smaller than a pixel, can never fully cover one
+    if (area < 0)
+        std::swap(p[1], p[2]);
+
+    // edge function E(x, y) = A * x + B * y + C for the edges p0p1, p1p2, p2p0
+    // a pixel is fully covered if E at its center is bigger than the half pixel extent along the
+    // edge normal (0.5 * |A| + 0.5 * |B|)
+    std::array<float, 3> A, B, C, bias;
+    for (int i{0}; i < 3; i++) {
+        const auto& from = p[i];
+        const auto& to = p[(i + 1) % 3];
+        A[i] = from.y() - to.y();
+        B[i] = to.x() - from.x();
+        C[i] = -(A[i] * from.x() + B[i] * from.y());
+        bias[i] = 0.5f * (std::abs(A[i]) + std::abs(B[i]));
+    }
+
+    int min_x = std::max(0, (int)std::floor(std::min({p[0].x(), p[1].x(), p[2].x()})));
+    int max_x = std::min(OCCLUSION_BUFFER_WIDTH - 1,
+                         (int)std::ceil(std::max({p[0].x(), p[1].x(), p[2].x()})));
+    int min_y = std::max(0, (int)std::floor(std::min({p[0].y(), p[1].y(), p[2].y()})));
+    int max_y = std::min(OCCLUSION_BUFFER_HEIGHT - 1,
+                         (int)std::ceil(std::max({p[0].y(), p[1].y(), p[2].y()})));
+
+    // conservative depth: the farthest point of the occluder
+    const Vec8f occluder_depth(std::max({tri.points[0].w(), tri.points[1].w(), tri.points[2].w()}));
+    const Vec8f lane_centers(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+
+    for (int y = min_y; y <= max_y; y++) {
+        float center_y = y + 0.5f;
+        float* row = &_depth[y * OCCLUSION_BUFFER_WIDTH];
+        // OCCLUSION_BUFFER_WIDTH is a multiple of 8 so a block never crosses the row end
+        for (int x = min_x & ~7; x <= max_x; x += 8) {
+            Vec8f center_x = Vec8f(static_cast<float>(x)) + lane_centers;
+            Vec8fb covered = (center_x * A[0] + (B[0] * center_y + C[0])) >= bias[0];
+            covered &= (center_x * A[1] + (B[1] * center_y + C[1])) >= bias[1];
+            covered &= (center_x * A[2] + (B[2] * center_y + C[2])) >= bias[2];
+            if (!horizontal_or(covered))
+                continue;
+
+            Vec8f depth = Vec8f().load(row + x);
+            depth = select(covered, min(depth, occluder_depth), depth);
+            depth.store(row + x);
+        }
+    }
+}
+
+bool OcclusionBuffer::isOccluded(const Triangle& tri) const {
+    const auto& [a, b, c] = tri.points;
+    int min_x = std::max(0, (int)std::floor(std::min({a.x(), b.x(), c.x()}) * _scaleX));
+    int max_x = std::min(OCCLUSION_BUFFER_WIDTH - 1,
+                         (int)std::floor(std::max({a.x(), b.x(), c.x()}) * _scaleX));
+    int min_y = std::max(0, (int)std::floor(std::min({a.y(), b.y(), c.y()}) * _scaleY));
+    int max_y = std::min(OCCLUSION_BUFFER_HEIGHT - 1,
+                         (int)std::floor(std::max({a.y(), b.y(), c.y()}) * _scaleY));
+    if (min_x > max_x || min_y > max_y)
+        return false;
+
+    // the closest point of the triangle has to be behind every occluder it overlaps
+    const Vec8f triangle_depth(std::min({a.w(), b.w(), c.w()}));
+    const Vec8f lane_offsets(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+
+    for (int y = min_y; y <= max_y; y++) {
+        const float* row = &_depth[y * OCCLUSION_BUFFER_WIDTH];
+        for (int x = min_x & ~7; x <= max_x; x += 8) {
+            Vec8f lane_x = Vec8f(static_cast<float>(x)) + lane_offsets;
+            Vec8fb in_box = (lane_x >= static_cast<float>(min_x)) &
+                            (lane_x <= static_cast<float>(max_x));
+            Vec8fb visible = in_box & (Vec8f().load(row + x) >= triangle_depth);
+            if (horizontal_or(visible))
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,194 @@
+//STL
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <numbers>
+#include <sstream>
+#include <thread>
+//INTERNAL
+#include <profiling.hpp>
+#include <renderFarm.hpp>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// keyframes are spread evenly over the frames of the job
+bool loadCameraPath(const std::string& path, std::vector<CameraKey>& keys) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        CameraKey key;
+        if (fields >> key.position.x() >> key.position.y() >> key.position.z() >> key.yaw >>
+            key.pitch)
+            keys.push_back(key);
+    }
+    return !keys.empty();
+}
+
+CameraKey cameraAt(const std::vector<CameraKey>& keys, int frame, int frames) {
+    if (keys.size() == 1 || frames == 1)
+        return keys.front();
+    float t = static_cast<float>(frame) / (frames - 1) * (keys.size() - 1);
+    size_t i = std::min(static_cast<size_t>(t), keys.size() - 2);
+    float f = t - i;
+    const auto& a = keys[i];
+    const auto& b = keys[i + 1];
+    return {a.position + (b.position - a.position) * f, a.yaw + (b.yaw - a.yaw) * f,
+            a.pitch + (b.pitch - a.pitch) * f};
+}
+}  // namespace
+
+bool RenderFarm::loadJobFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open job file: " << path << '\n';
+        return false;
+    }
+    auto base = std::filesystem::path(path).parent_path();
+    auto resolve = [&](const std::string& file) {
+        std::filesystem::path file_path(file);
+        return file_path.is_relative() ? (base / file_path).string() : file;
+    };
+
+    _jobs.clear();
+    _results.clear();
+    std::string line;
+    for (int line_number{1}; std::getline(in, line); line_number++) {
+        std::istringstream fields(line);
+        std::string model;
+        if (!(fields >> model) || model.front() == '#')
+            continue;
+        RenderJob job{};
+        std::string size;
+        int mode;
+        if (!(fields >> size >> mode >> job.frames >> job.cameraPath) ||
+            std::sscanf(size.c_str(), "%dx%d", &job.width, &job.height) != 2 || job.width <= 0 ||
+            job.height <= 0 || mode < 1 || mode > 6 || job.frames <= 0) {
+            std::cerr << path << ":" << line_number
+                      << ": expected <model> <width>x<height> <render mode 1-6> <frames>"
+                         " <camera path>\n";
+            return false;
+        }
+        job.modelPath = resolve(model);
+        job.mode = static_cast<RenderMode>(mode - 1);
+        if (job.cameraPath != TURNTABLE_CAMERA_PATH)
+            job.cameraPath = resolve(job.cameraPath);
+        _jobs.push_back(std::move(job));
+    }
+    return true;
+}
+
+bool RenderFarm::run(const std::filesystem::path& output_dir, const std::string& image_format,
+                     unsigned threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, _jobs.size()));
+    _results.assign(_jobs.size(), {});
+
+    // every thread takes the next job until none is left
+    std::atomic<size_t> next_job{0};
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned i{0}; i < threads; i++) {
+            workers.emplace_back([&] {
+                PROFILE_THREAD_NAME("Render farm worker");
+                for (size_t job; (job = next_job++) < _jobs.size();) {
+                    // an exception leaving the thread would end the whole batch, the job fails
+                    try {
+                        _results[job] = renderJob(job, output_dir, image_format);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Job " << job << " failed: " << e.what() << '\n';
+                    }
+                }
+            });
+        }
+    }
+    return std::all_of(_results.begin(), _results.end(),
+                       [](const RenderJobResult& result) { return result.succeeded; });
+}
+
+RenderJobResult RenderFarm::renderJob(size_t index, const std::filesystem::path& output_dir,
+                                      const std::string& image_format) const {
+    const auto& job = _jobs[index];
+    RenderJobResult result;
+    auto start = Clock::now();
+
+    bool turntable = job.cameraPath == TURNTABLE_CAMERA_PATH;
+    std::vector<CameraKey> keys;
+    if (!turntable && !loadCameraPath(job.cameraPath, keys)) {
+        std::cerr << "Invalid camera path: " << job.cameraPath << '\n';
+        return result;
+    }
+    Renderer renderer;
+    renderer.setRenderMode(job.mode);
+    if (!renderer.initializeOffscreen(job.width, job.height) ||
+        !renderer.setupWindow(job.modelPath)) {
+        std::cerr << "Failed to setup job " << index << ": " << job.modelPath << '\n';
+        renderer.destroyWindow();
+        return result;
+    }
+    auto stem = std::filesystem::path(job.modelPath).stem().string();
+    char number[16];
+    std::snprintf(number, sizeof(number), "%03zu", index);
+    auto job_dir = output_dir / (number + ("_" + stem));
+    std::error_code ec;
+    std::filesystem::create_directories(job_dir, ec);
+    result.loadMs = elapsedMs(start);
+
+    for (int frame{0}; frame < job.frames; frame++) {
+        if (turntable) {
+            float angle = 2.f * std::numbers::pi_v<float> * frame / job.frames;
+            renderer.setModelRotation({0.f, angle, 0.f});
+        } else {
+            auto key = cameraAt(keys, frame, job.frames);
+            renderer.setCamera(key.position, key.yaw, key.pitch);
+        }
+        auto frame_start = Clock::now();
+        renderer.update();
+        renderer.render(0.0);
+        double frame_ms = elapsedMs(frame_start);
+        result.renderMs += frame_ms;
+        result.minFrameMs = frame == 0 ? frame_ms : std::min(result.minFrameMs, frame_ms);
+        result.maxFrameMs = std::max(result.maxFrameMs, frame_ms);
+
+        auto write_start = Clock::now();
+        std::snprintf(number, sizeof(number), "%04d", frame);
+        if (!renderer.saveFrame((job_dir / (stem + "_" + number + "." + image_format)).string())) {
+            renderer.destroyWindow();
+            return result;
+        }
+        result.writeMs += elapsedMs(write_start);
+    }
+    renderer.destroyWindow();
+    result.succeeded = true;
+    return result;
+}
+
+bool RenderFarm::writeReport(const std::filesystem::path& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    out << "job,model,camera,width,height,mode,frames,status,load_ms,render_ms,write_ms,"
+           "mean_frame_ms,min_frame_ms,max_frame_ms\n";
+    for (size_t i{0}; i < _jobs.size() && i < _results.size(); i++) {
+        const auto& job = _jobs[i];
+        const auto& result = _results[i];
+        out << i << ',' << job.modelPath << ',' << job.cameraPath << ',' << job.width << ','
+            << job.height << ',' << static_cast<int>(job.mode) + 1 << ',' << job.frames << ','
+            << (result.succeeded ? "ok" : "failed") << ',' << result.loadMs << ','
+            << result.renderMs << ',' << result.writeMs << ',' << result.renderMs / job.frames
+            << ',' << result.minFrameMs << ',' << result.maxFrameMs << '\n';
+    }
+    if (!out) {
+        std::cerr << "Failed to write report: " << path.string() << '\n';
+        return false;
+    }
+    return true;
+}
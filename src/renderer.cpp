@@ -1,10 +1,17 @@
 //STL
+#include <algorithm>
 #include <iostream>
+#include <utility>
 //INTERNAL
+#include <imageWriter.hpp>
+#include <meshCache.hpp>
+#include <meshOptimizer.hpp>
+#include <meshQuantization.hpp>
+#include <objLoader.hpp>
+#include <profiling.hpp>
 #include <renderer.hpp>
-#ifdef TRACY_ENABLE
-#include <tracy/Tracy.hpp>
-#endif
+#include <textureCache.hpp>
+
 bool Renderer::initializeWindow(bool fullscreen) {
     if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
         std::cerr << "Error initializing SDL\n";
@@ -19,6 +26,7 @@ bool Renderer::initializeWindow(bool fullscreen) {
         std::cout << "-Screen refersh_rate: " << display_mode.refresh_rate << " Hz\n";
         std::cout << "-Screen dims: " << _windowWidth << "x" << _windowHeight << '\n';
     }
+    std::cout << "-CPU kernels: " << kernels().name << '\n';
 
     if (_windowPtr = std::unique_ptr<SDL_Window, decltype(&SDL_DestroyWindow)>(
             SDL_CreateWindow(nullptr, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, _windowWidth,
@@ -46,21 +54,59 @@ bool Renderer::initializeWindow(bool fullscreen) {
             return false;
         }
         _ttfTextRenerer = TTF_OpenFont("Roboto-Regular.ttf", 24);
+        // the HUD text is drawn from glyphs rasterized once here
+        if (!_glyphAtlas.build(_rendererPtr.get(), _ttfTextRenerer))
+            std::cerr << "Unable to load the HUD font: " << TTF_GetError() << '\n';
     }
 
     return _isRunning = true;
 }
 
+bool Renderer::initializeOffscreen(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Invalid offscreen size: " << width << "x" << height << '\n';
+        return false;
+    }
+    _windowWidth = width;
+    _windowHeight = height;
+    _headless = true;
+    std::cout << "-Offscreen dims: " << _windowWidth << "x" << _windowHeight << '\n';
+    std::cout << "-CPU kernels: " << kernels().name << '\n';
+    return _isRunning = true;
+}
+
 bool Renderer::setupWindow(const std::string& obj_file_path) {
+    _renderWidth = _windowWidth;
+    _renderHeight = _windowHeight;
     _colorBuffer.resize(_windowWidth * _windowHeight);
-
-    if (_colorBufferTexturePtr = std::unique_ptr<SDL_Texture, decltype(&SDL_DestroyTexture)>(
-            SDL_CreateTexture(_rendererPtr.get(), SDL_PIXELFORMAT_ABGR8888,
-                              SDL_TextureAccess::SDL_TEXTUREACCESS_STREAMING, _windowWidth, _windowHeight),
-            SDL_DestroyTexture);
-        !_colorBufferTexturePtr) {
-        std::cout << "falied to create Texture\n";
+    _colorPixels = _colorBuffer.data();
+    _colorPitch = _renderWidth;
+
+    // an offscreen renderer has nothing to present to
+    if (!_headless) {
+        if (_colorBufferTexturePtr = std::unique_ptr<SDL_Texture, decltype(&SDL_DestroyTexture)>(
+                SDL_CreateTexture(_rendererPtr.get(), SDL_PIXELFORMAT_ABGR8888,
+                                  SDL_TextureAccess::SDL_TEXTUREACCESS_STREAMING, _windowWidth,
+                                  _windowHeight),
+                SDL_DestroyTexture);
+            !_colorBufferTexturePtr) {
+            std::cout << "falied to create Texture\n";
+            return false;
+        }
+    }
+    if (!_videoOutputPath.empty() &&
+        !_videoSink.open(_videoOutputPath, _windowWidth, _windowHeight, _fps, !_headless))
         return false;
+    if (!_headless) {
+        // the video sink reads the frames from the color buffer
+        _zeroCopyPresent = !_videoSink.isOpen() && zeroCopySupported();
+        std::cout << "-Presentation: " << (_zeroCopyPresent ? "zero-copy" : "copy") << '\n';
+    }
+    // offscreen frames and videos keep the requested size
+    _dynamicResolution = _dynamicResolution && !_headless && !_videoSink.isOpen();
+    if (_dynamicResolution) {
+        _resolutionScaler.setBudget(_frameTargetTime);
+        SDL_SetTextureScaleMode(_colorBufferTexturePtr.get(), SDL_ScaleModeLinear);
     }
 
     auto aspectRatioY{static_cast<float>(_windowHeight) / _windowWidth};
@@ -76,173 +122,184 @@ bool Renderer::setupWindow(const std::string& obj_file_path) {
 
     constructProjectionMatrix(fovY, aspectRatioY, zNear, zFar);
     initializeFrustumPlanes(fovX, fovY, zNear, zFar);
+    _occlusionBuffer.setScreenSize(_renderWidth, _renderHeight);
+
+    if (std::filesystem::path(obj_file_path).extension() == ".rstream") {
+        // out-of-core mesh, update() streams in the chunks the camera sees
+        _streamingMesh = std::make_unique<StreamingMesh>(_streamingBudget, _quantizeMeshes);
+        if (!_streamingMesh->open(obj_file_path)) {
+            std::cerr << "Invalid stream file: " << obj_file_path << '\n';
+            return false;
+        }
+        _pathes = {obj_file_path};
+        _currentObjPathIt = _pathes.begin();
+        auto model = std::make_shared<ModelData>();  // holds the texture, the chunks the faces
+        auto png_path = std::filesystem::path(obj_file_path).replace_extension(".png");
+        if (std::filesystem::exists(png_path))
+            loadPNGTextureData(png_path.string(), *model);
+        applyModel(std::move(model));
+        return true;
+    }
 
-    if (_pathes.empty()) {
+    if (_pathes.empty() && _headless) {
+        // offscreen and batch runs render exactly the requested model and never switch models,
+        // so there is no directory to scan
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(obj_file_path, ec)) {
+            std::cerr << "Model not found: " << obj_file_path << '\n';
+            return false;
+        }
+        _pathes = {obj_file_path};
+        _currentObjPathIt = _pathes.begin();
+    } else if (_pathes.empty()) {
         auto dir_path = std::filesystem::path(obj_file_path).parent_path();
-        for (auto it : std::filesystem::directory_iterator(dir_path)) {
-            if (it.path().extension() == ".obj") {
-                _pathes.push_back(it.path());
+        if (dir_path.empty())
+            dir_path = ".";
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(dir_path, ec), end; !ec && it != end;
+             it.increment(ec)) {
+            if (it->path().extension() == ".obj") {
+                _pathes.push_back(it->path());
             }
         }
-        _currentObjPathIt = _pathes.begin();
+        // Enter walks through the directory starting at the requested model
+        auto file_name = std::filesystem::path(obj_file_path).filename();
+        _currentObjPathIt = std::find_if(_pathes.begin(), _pathes.end(), [&](const auto& path) {
+            return path.filename() == file_name;
+        });
+        if (_currentObjPathIt == _pathes.end()) {
+            if (_pathes.empty()) {
+                std::cerr << "Model not found: " << obj_file_path << '\n';
+                return false;
+            }
+            _currentObjPathIt = _pathes.begin();
+        }
+    }
+    // the first model is loaded before the first frame, the following ones in the background
+    auto path = _currentObjPathIt->string();
+    auto model = _modelLoader.cache().get(path);
+    if (!model) {
+        auto loaded = std::make_shared<ModelData>();
+        loadModelData(path, *loaded, _optimizeMeshes, _quantizeMeshes);
+        _modelLoader.cache().put(path, loaded);
+        model = std::move(loaded);
     }
-    loadModelData(_pathes[0].string());
+    applyModel(std::move(model));
+    // an offscreen renderer never switches models, there is nothing to prefetch
+    if (!_headless)
+        requestModels();
     return true;
 }
 
-void Renderer::drawPixel(int x, int y, uint32_t color) {
-    if (x >= 0 && x < _windowWidth && y >= 0 && y < _windowHeight) {
-        _colorBuffer[(_windowWidth * y) + x] = color;
-    }
+namespace {
+// pixels the rasterization job on this thread depth tested or drew, summed up per tile
+thread_local uint64_t t_rasterizedPixels = 0;
+
+// 1/w and the texture coordinates divided by w are constant for the whole triangle
+SpanTriangle makeSpanTriangle(const Vector4f& a, const Vector4f& b, const Vector4f& c,
+                              const Vector2f& a_uv, const Vector2f& b_uv, const Vector2f& c_uv) {
+    return {.ax = a.x(), .ay = a.y(), .bx = b.x(), .by = b.y(), .cx = c.x(), .cy = c.y(),
+            .inv_aw = 1 / a.w(), .inv_bw = 1 / b.w(), .inv_cw = 1 / c.w(),
+            .au_w = a_uv.x() / a.w(), .av_w = a_uv.y() / a.w(),
+            .bu_w = b_uv.x() / b.w(), .bv_w = b_uv.y() / b.w(),
+            .cu_w = c_uv.x() / c.w(), .cv_w = c_uv.y() / c.w()};
 }
+}  // namespace
 
-void Renderer::drawTexel(const Vector2i& point, const std::vector<uint32_t>& texture,
-                         const Vector4f& a, const Vector4f& b, const Vector4f& c,
-                         const Vector2f& uv0, const Vector2f& uv1, const Vector2f& uv2) {
-    Vector2f point_p{(float)point.x(), (float)point.y()};
-    Vector3f weights = barycentric_weights(Vector2f{a.x(), a.y()}, Vector2f{b.x(), b.y()},
-                                          Vector2f{c.x(), c.y()}, point_p);
-
-    float alpha = weights.x();
-    float beta = weights.y();
-    float gamma = weights.z();
-
-    // Variables to store the interpolated values of U, V, and also 1/w for the current pixel
-    float interpolated_u;
-    float interpolated_v;
-    float interpolated_reciprocal_w;
-
-    // Perform the interpolation of all U/w and V/w values using barycentric weights and a factor of 1/w
-    // removed the distortion
-    interpolated_u =
-        (uv0.x() / a.w()) * alpha + (uv1.x() / b.w()) * beta + (uv2.x() / c.w()) * gamma;
-    interpolated_v =
-        (uv0.y() / a.w()) * alpha + (uv1.y() / b.w()) * beta + (uv2.y() / c.w()) * gamma;
-
-    // Also interpolate the value of 1/w for the current pixel
-    interpolated_reciprocal_w =
-        (1 / a.w()) * alpha + (1 / b.w()) * beta + (1 / c.w()) * gamma;
-
-    // Now we can divide back both interpolated values by 1/w
-    interpolated_u /= interpolated_reciprocal_w;
-    interpolated_v /= interpolated_reciprocal_w;
-
-    // Map the UV coordinate to the full texture width and height 
-    int tex_x = abs((int)(interpolated_u * _textureWidth)) % _textureWidth;
-    int tex_y = abs((int)(interpolated_v * _textureHeight)) % _textureHeight;
-
-    // Adjust 1/w so the pixels that are closer to the camera have smaller values
-    interpolated_reciprocal_w = 1.0 - interpolated_reciprocal_w;
-
-    // Only draw the pixel if the depth value is less than the one previously stored in the z-buffer
-    if ((_windowWidth * point.y()) + point.x() < _zBuffer.size()) {
-        if (interpolated_reciprocal_w < _zBuffer[(_windowWidth * point.y()) + point.x()]) {
-            // Draw a pixel at position (x,y) with the color that comes from the mapped texture
-            drawPixel(point.x(), point.y(), texture[(_textureWidth * tex_y) + tex_x]);
-
-            // Update the z-buffer value with the 1/w of this current pixel
-            _zBuffer[(_windowWidth * point.y()) + point.x()] = interpolated_reciprocal_w;
-        }
+void Renderer::drawPixel(const Tile& tile, int x, int y, uint32_t color) {
+    if (tile.contains(x, y)) {
+        colorRow(y)[x] = color;
+        t_rasterizedPixels++;
     }
 }
 
-void Renderer::drawTrianglePixel(int x, int y, uint32_t color, const Vector4f& a, const Vector4f& b,
-                                 const Vector4f& c) {
-    // Create three vec2 to find the interpolation
-    Vector2f p = {(float)x, (float)y};
-    Vector3f weights = barycentric_weights(Vector2f{a.x(), a.y()}, Vector2f{b.x(), b.y()},
-                                           Vector2f{c.x(), c.y()}, p);
-
-    float alpha = weights.x();
-    float beta = weights.y();
-    float gamma = weights.z();
-
-    // Interpolate the value of 1/w for the current pixel
-    float interpolated_reciprocal_w =
-        (1 / a.w()) * alpha + (1 / b.w()) * beta + (1 / c.w()) * gamma;
-
-    // Adjust 1/w so the pixels that are closer to the camera have smaller values
-    interpolated_reciprocal_w = 1.0 - interpolated_reciprocal_w;
-
-    // Only draw the pixel if the depth value is less than the one previously stored in the z-buffer
-    if ((_windowWidth * y) + x <= _zBuffer.size()) {
-        if (interpolated_reciprocal_w < _zBuffer[(_windowWidth * y) + x]) {
-            // Draw a pixel at position (x,y) with a solid color
-            drawPixel(x, y, color);
-
-            // Update the z-buffer value with the 1/w of this current pixel
-            _zBuffer[(_windowWidth * y) + x] = interpolated_reciprocal_w;
-        }
-    }
+void Renderer::drawSpan(const Tile& tile, const SpanTriangle& span, int y, int x_start, int x_end,
+                        uint32_t color) {
+    // pixels outside of the tile belong to another rasterization job
+    x_start = std::max(x_start, tile.minX);
+    x_end = std::min(x_end, tile.maxX);
+    t_rasterizedPixels += std::max(x_end - x_start, 0);
+    if (x_start < x_end)
+        kernels().shadeSpan(span, y, x_start, x_end, color, colorRow(y),
+                            &_zBuffer[_renderWidth * y]);
 }
 
-Vector3f Renderer::barycentric_weights(const Vector2f& a, const Vector2f& b, const Vector2f& c,
-                                      const Vector2f& p) {
-    // Find the vectors between the vertices ABC and point p
-    auto ac = c - a;
-    auto ab = b - a;
-    auto ap = p - a;
-    auto pc = c - p;
-    auto pb = b - p;
-
-    // Compute the area of the full parallegram/triangle ABC using 2D cross product
-    float area_parallelogram_abc = (ac.x() * ab.y() - ac.y() * ab.x());  // || AC x AB ||
-
-    // Alpha is the area of the small parallelogram/triangle PBC divided by the area of the full parallelogram/triangle ABC
-    float alpha = (pc.x() * pb.y() - pc.y() * pb.x()) / area_parallelogram_abc;
-
-    // Beta is the area of the small parallelogram/triangle APC divided by the area of the full parallelogram/triangle ABC
-    float beta = (ac.x() * ap.y() - ac.y() * ap.x()) / area_parallelogram_abc;
-
-    // Weight gamma is easily found since barycentric coordinates always add up to 1.0
-    float gamma = 1 - alpha - beta;
-
-    return {alpha, beta, gamma};
+void Renderer::drawTexturedSpan(const Tile& tile, const SpanTriangle& span, int y, int x_start,
+                                int x_end, const std::vector<uint32_t>& texture) {
+    x_start = std::max(x_start, tile.minX);
+    x_end = std::min(x_end, tile.maxX);
+    t_rasterizedPixels += std::max(x_end - x_start, 0);
+    if (x_start < x_end)
+        kernels().textureSpan(span, y, x_start, x_end, texture.data(),
+                              _mesh.data->textureWidth, _mesh.data->textureHeight, colorRow(y),
+                              &_zBuffer[_renderWidth * y]);
 }
 
-void Renderer::drawGrid() {
-    for (uint32_t y{0}; y < _windowHeight; y += 20) {
-        for (uint32_t x{0}; x < _windowWidth; x += 20) {
-            _colorBuffer[(_windowWidth * y) + x] = 0xFFFFFFFF;
+void Renderer::drawGrid(const Tile& tile) {
+    // first row of the tile that is on the 20 pixels grid
+    int first_y = tile.minY + (20 - tile.minY % 20) % 20;
+    for (int y{first_y}; y < tile.maxY; y += 20) {
+        for (int x{0}; x < _renderWidth; x += 20) {
+            colorRow(y)[x] = 0xFFFFFFFF;
         }
     }
 }
 
-void Renderer::drawRect(int x, int y, int width, int height, uint32_t color) {
+void Renderer::drawRect(const Tile& tile, int x, int y, int width, int height, uint32_t color) {
     for (int j = 0; j < height; j++) {
         for (int i = 0; i < width; i++) {
             int current_x = x + i;
             int current_y = y + j;
-            drawPixel(current_x, current_y, color);
+            drawPixel(tile, current_x, current_y, color);
         }
     }
 }
 
 // DDA(digital differential analyzer) line drawing algorithm
 // there is also another faster algorithm called Bresenham's line algorithm
-void Renderer::drawLine(int x0, int y0, int x1, int y1, uint32_t color) {
+void Renderer::drawLine(const Tile& tile, int x0, int y0, int x1, int y1, uint32_t color) {
     int delta_x = (x1 - x0);
     int delta_y = (y1 - y0);
 
     float longest_side_length = (abs(delta_x) >= abs(delta_y)) ? static_cast<float>(abs(delta_x)) : static_cast<float>(abs(delta_y));
 
+    if (longest_side_length == 0) {
+        drawPixel(tile, x0, y0, color);
+        return;
+    }
+
     float x_inc = delta_x / longest_side_length;
     float y_inc = delta_y / longest_side_length;
 
-    float current_x = x0;
-    float current_y = y0;
+    // a tile only walks the steps inside of it, every step is computed from the start of the
+    // line so all tiles that the line crosses agree on its pixels
+    int first_step{0};
+    int last_step{static_cast<int>(longest_side_length)};
+    auto clipSteps = [&](int start, float inc, int min, int max) {
+        if (inc == 0) {
+            if (start < min || start >= max)
+                last_step = -1;
+            return;
+        }
+        auto [to_first, to_last] = std::minmax({(min - start) / inc, (max - start) / inc});
+        // one step of slack for the rounding, drawPixel() drops what is still outside
+        first_step = std::max(first_step, static_cast<int>(std::floor(to_first)) - 1);
+        last_step = std::min(last_step, static_cast<int>(std::ceil(to_last)) + 1);
+    };
+    clipSteps(x0, x_inc, tile.minX, tile.maxX);
+    clipSteps(y0, y_inc, tile.minY, tile.maxY);
 
-    for (int i = 0; i <= longest_side_length; i++) {
-        drawPixel(static_cast<int>(current_x), static_cast<int>(current_y), color);
-        current_x += x_inc;
-        current_y += y_inc;
+    for (int i = first_step; i <= last_step; i++) {
+        drawPixel(tile, static_cast<int>(x0 + i * x_inc), static_cast<int>(y0 + i * y_inc),
+                  color);
     }
 }
 
-void Renderer::drawTriangle(const Triangle& tri, uint32_t color) {
-    drawLine(tri.points[0].x(), tri.points[0].y(), tri.points[1].x(), tri.points[1].y(), color);
-    drawLine(tri.points[1].x(), tri.points[1].y(), tri.points[2].x(), tri.points[2].y(), color);
-    drawLine(tri.points[2].x(), tri.points[2].y(), tri.points[0].x(), tri.points[0].y(), color);
+void Renderer::drawTriangle(const Tile& tile, const Triangle& tri, uint32_t color) {
+    PROFILE_ZONE("drawTriangle");
+    drawLine(tile, tri.points[0].x(), tri.points[0].y(), tri.points[1].x(), tri.points[1].y(), color);
+    drawLine(tile, tri.points[1].x(), tri.points[1].y(), tri.points[2].x(), tri.points[2].y(), color);
+    drawLine(tile, tri.points[2].x(), tri.points[2].y(), tri.points[0].x(), tri.points[0].y(), color);
 }
 
 //   flat bottom triangle
@@ -254,8 +311,9 @@ void Renderer::drawTriangle(const Triangle& tri, uint32_t color) {
 //  |       /       \
 //  |      /         \
 //  v +y (x1,y1)------(x2,y2)
-void Renderer::rasterizeFlatBottomTriangle(const Vector2i& p0, const Vector2i& p1,
+void Renderer::rasterizeFlatBottomTriangle(const Tile& tile, const Vector2i& p0, const Vector2i& p1,
                                            const Vector2i& p2, uint32_t color) {
+    PROFILE_ZONE("rasterizeFlatBottomTriangle");
     // Find the two inverse slopes (two triangle legs)
     // inverse slope = run / rise, which tells us how much x changes for each unit change in y
     // since we are looping over y (scanline by scanline), while slope = rise / run
@@ -272,7 +330,7 @@ void Renderer::rasterizeFlatBottomTriangle(const Vector2i& p0, const Vector2i& p
 
     // Loop all the scanlines from top to bottom
     for (int y = p0.y(); y <= p2.y(); y++) {
-        drawLine(x_start, y, x_end, y, color);
+        drawLine(tile, x_start, y, x_end, y, color);
         x_start += inv_slope_1;
         x_end += inv_slope_2;
     }
@@ -288,8 +346,9 @@ void Renderer::rasterizeFlatBottomTriangle(const Vector2i& p0, const Vector2i& p
 // |         \ /
 // |       (x2,y2)
 // v +y
-void Renderer::rasterizeFlatTopTriangle(const Vector2i& p0, const Vector2i& p1, const Vector2i& p2,
-                                        uint32_t color) {
+void Renderer::rasterizeFlatTopTriangle(const Tile& tile, const Vector2i& p0, const Vector2i& p1,
+                                        const Vector2i& p2, uint32_t color) {
+    PROFILE_ZONE("rasterizeFlatTopTriangle");
     // Find the two slopes (two triangle legs)
     float inv_slope_1{};
     float inv_slope_2{};
@@ -304,7 +363,7 @@ void Renderer::rasterizeFlatTopTriangle(const Vector2i& p0, const Vector2i& p1,
 
     // Loop all the scanlines from bottom to top
     for (int y = p2.y(); y >= p0.y(); y--) {
-        drawLine(x_start, y, x_end, y, color);
+        drawLine(tile, x_start, y, x_end, y, color);
         x_start -= inv_slope_1;
         x_end -= inv_slope_2;
     }
@@ -328,7 +387,8 @@ void Renderer::rasterizeFlatTopTriangle(const Vector2i& p0, const Vector2i& p1,
 //                           \
 //                         (x2,y2)
 //
-void Renderer::rasterizeTriangle1(const Triangle& tri, uint32_t color)  {
+void Renderer::rasterizeTriangle1(const Tile& tile, const Triangle& tri, uint32_t color)  {
+    PROFILE_ZONE("rasterizeTriangle1");
     std::array<Vector2i, 3> verts = {
         Vector2i{(int)tri.points[0].x(), (int)tri.points[0].y()},
         Vector2i{(int)tri.points[1].x(), (int)tri.points[1].y()},
@@ -344,10 +404,10 @@ void Renderer::rasterizeTriangle1(const Triangle& tri, uint32_t color)  {
 
     if (y1 == y2) {
         // Draw flat-bottom triangle
-        rasterizeFlatBottomTriangle({x0, y0}, {x1, y1}, {x2, y2}, color);
+        rasterizeFlatBottomTriangle(tile, {x0, y0}, {x1, y1}, {x2, y2}, color);
     } else if (y0 == y1) {
         // Draw flat-top triangle
-        rasterizeFlatTopTriangle({x0, y0}, {x1, y1}, {x2, y2}, color);
+        rasterizeFlatTopTriangle(tile, {x0, y0}, {x1, y1}, {x2, y2}, color);
     } else {
         // Calculate the new vertex (Mx,My) using triangle similarity
         // Mx - x0      y1 - y0
@@ -359,13 +419,14 @@ void Renderer::rasterizeTriangle1(const Triangle& tri, uint32_t color)  {
         float My = y1;
 
         // Draw flat-bottom triangle
-        rasterizeFlatBottomTriangle({x0, y0}, {x1, y1}, {(int)Mx, (int)My}, color);
+        rasterizeFlatBottomTriangle(tile, {x0, y0}, {x1, y1}, {(int)Mx, (int)My}, color);
         // Draw flat-top triangle
-        rasterizeFlatTopTriangle({x1, y1}, {(int)Mx, (int)My}, {x2, y2}, color);
+        rasterizeFlatTopTriangle(tile, {x1, y1}, {(int)Mx, (int)My}, {x2, y2}, color);
     }
 }
 
-void Renderer::rasterizeTriangle2(const Triangle& tri, uint32_t color) {
+void Renderer::rasterizeTriangle2(const Tile& tile, const Triangle& tri, uint32_t color) {
+    PROFILE_ZONE("rasterizeTriangle2");
     std::array<std::tuple<Eigen::Vector2i, Eigen::Vector2f, Eigen::Vector2f>, 3> verts = {
         {{{(int)tri.points[0].x(), (int)tri.points[0].y()}, {tri.points[0].z(), tri.points[0].w()}, tri.text_coords[0]},
          {{(int)tri.points[1].x(), (int)tri.points[1].y()}, {tri.points[1].z(), tri.points[1].w()}, tri.text_coords[0]},
@@ -405,6 +466,7 @@ void Renderer::rasterizeTriangle2(const Triangle& tri, uint32_t color) {
     Vector2f a_uv = {u0, v0};
     Vector2f b_uv = {u1, v1};
     Vector2f c_uv = {u2, v2};
+    auto span = makeSpanTriangle(point_a, point_b, point_c, a_uv, b_uv, c_uv);
 
     // Render flat-bottom triangle
     float inv_slope_1 = 0;
@@ -416,7 +478,8 @@ void Renderer::rasterizeTriangle2(const Triangle& tri, uint32_t color) {
         inv_slope_2 = (float)(x2 - x0) / abs(y2 - y0);
 
     if (y1 - y0 != 0) {
-        for (int y = y0; y <= y1; y++) {
+        // only the scanlines inside the tile
+        for (int y = std::max(y0, tile.minY); y <= std::min(y1, tile.maxY - 1); y++) {
             int x_start = x1 + (y - y1) * inv_slope_1;
             int x_end = x0 + (y - y0) * inv_slope_2;
 
@@ -424,10 +487,7 @@ void Renderer::rasterizeTriangle2(const Triangle& tri, uint32_t color) {
                 std::swap(x_start, x_end);  // swap if x_start is to the right of x_end
             }
 
-            for (int x = x_start; x < x_end; x++) {
-                // Draw our pixel with the color that comes from the texture
-                drawTrianglePixel(x, y, color, point_a, point_b, point_c);
-            }
+            drawSpan(tile, span, y, x_start, x_end, color);
         }
     }
 
@@ -441,7 +501,7 @@ void Renderer::rasterizeTriangle2(const Triangle& tri, uint32_t color) {
         inv_slope_2 = (float)(x2 - x0) / abs(y2 - y0);
 
     if (y2 - y1 != 0) {
-        for (int y = y1; y <= y2; y++) {
+        for (int y = std::max(y1, tile.minY); y <= std::min(y2, tile.maxY - 1); y++) {
             int x_start = x1 + (y - y1) * inv_slope_1;
             int x_end = x0 + (y - y0) * inv_slope_2;
 
@@ -449,15 +509,14 @@ void Renderer::rasterizeTriangle2(const Triangle& tri, uint32_t color) {
                 std::swap(x_start, x_end);  // swap if x_start is to the right of x_end
             }
 
-            for (int x = x_start; x < x_end; x++) {
-                // Draw our pixel with the color that comes from the texture
-                drawTrianglePixel(x, y, color, point_a, point_b, point_c);
-            }
+            drawSpan(tile, span, y, x_start, x_end, color);
         }
     }
 }
 
-void Renderer::rasterizeTexturedTriangle(const Triangle& tri, const std::vector<uint32_t>& textureBuffer) {
+void Renderer::rasterizeTexturedTriangle(const Tile& tile, const Triangle& tri,
+                                         const std::vector<uint32_t>& textureBuffer) {
+    PROFILE_ZONE("rasterizeTexturedTriangle");
     std::array<std::tuple<Vector2i, Vector2f, Vector2f>, 3> verts = {
         {{{(int)tri.points[0].x(), (int)tri.points[0].y()}, {tri.points[0].z(), tri.points[0].w()}, tri.text_coords[0]},
          {{(int)tri.points[1].x(), (int)tri.points[1].y()}, {tri.points[1].z(), tri.points[1].w()}, tri.text_coords[1]},
@@ -498,6 +557,7 @@ void Renderer::rasterizeTexturedTriangle(const Triangle& tri, const std::vector<
     Vector2f a_uv = {u0, v0};
     Vector2f b_uv = {u1, v1};
     Vector2f c_uv = {u2, v2};
+    auto span = makeSpanTriangle(point_a, point_b, point_c, a_uv, b_uv, c_uv);
 
     ///////////////////////////////////////////////////////
     // Render the upper part of the triangle (flat-bottom)
@@ -511,7 +571,8 @@ void Renderer::rasterizeTexturedTriangle(const Triangle& tri, const std::vector<
         inv_slope_2 = (float)(x2 - x0) / abs(y2 - y0);
 
     if (y1 - y0 != 0) {
-        for (int y = y0; y <= y1; y++) {
+        // only the scanlines inside the tile
+        for (int y = std::max(y0, tile.minY); y <= std::min(y1, tile.maxY - 1); y++) {
             int x_start = x1 + (y - y1) * inv_slope_1;
             int x_end = x0 + (y - y0) * inv_slope_2;
 
@@ -519,10 +580,7 @@ void Renderer::rasterizeTexturedTriangle(const Triangle& tri, const std::vector<
                 std::swap(x_start, x_end);  // swap if x_start is to the right of x_end
             }
 
-            for (int x = x_start; x < x_end; x++) {
-                // Draw our pixel with the color that comes from the texture
-                drawTexel({x, y}, textureBuffer, point_a, point_b, point_c, a_uv, b_uv, c_uv);
-            }
+            drawTexturedSpan(tile, span, y, x_start, x_end, textureBuffer);
         }
     }
     
@@ -538,7 +596,7 @@ void Renderer::rasterizeTexturedTriangle(const Triangle& tri, const std::vector<
         inv_slope_2 = (float)(x2 - x0) / abs(y2 - y0);
 
     if (y2 - y1 != 0) {
-        for (int y = y1; y <= y2; y++) {
+        for (int y = std::max(y1, tile.minY); y <= std::min(y2, tile.maxY - 1); y++) {
             int x_start = x1 + (y - y1) * inv_slope_1;
             int x_end = x0 + (y - y0) * inv_slope_2;
 
@@ -546,10 +604,7 @@ void Renderer::rasterizeTexturedTriangle(const Triangle& tri, const std::vector<
                 std::swap(x_start, x_end);  // swap if x_start is to the right of x_end
             }
 
-            for (int x = x_start; x < x_end; x++) {
-                // Draw our pixel with the color that comes from the texture
-                drawTexel({x, y}, textureBuffer, point_a, point_b, point_c, a_uv, b_uv, c_uv);
-            }
+            drawTexturedSpan(tile, span, y, x_start, x_end, textureBuffer);
         }
     }
 
@@ -578,17 +633,74 @@ Eigen::Matrix4f Renderer::lookAt(const Vector3f& eye, const Vector3f& target,
 }
 
 void Renderer::renderColorBuffer() {
-    SDL_UpdateTexture(_colorBufferTexturePtr.get(), nullptr, _colorBuffer.data(),
-                      (int)(sizeof(uint32_t) * _windowWidth)  //Pitch ==> size of one row in bytes
-    );
-    SDL_RenderCopy(_rendererPtr.get(), _colorBufferTexturePtr.get(), nullptr, nullptr);
+    PROFILE_ZONE("renderColorBuffer");
+    const SDL_Rect render_rect{0, 0, _renderWidth, _renderHeight};
+    // the texture still holds the color buffer when nothing was rasterized this frame
+    if (_colorBufferChanged) {
+        SDL_UpdateTexture(_colorBufferTexturePtr.get(), &render_rect, _colorBuffer.data(),
+                          (int)(sizeof(uint32_t) * _renderWidth)  //Pitch ==> size of one row in bytes
+        );
+        _colorBufferChanged = false;
+    }
+    // a lower render resolution is scaled up to the window here
+    SDL_RenderCopy(_rendererPtr.get(), _colorBufferTexturePtr.get(), &render_rect, nullptr);
+}
+
+bool Renderer::zeroCopySupported() const {
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(_rendererPtr.get(), &info) != 0)
+        return false;
+    // the Direct3D renderers lock mapped GPU memory, the rasterizer reads back every pixel it
+    // depth tests against which is slow there
+    if (std::string_view(info.name).starts_with("direct3d"))
+        return false;
+    // a format the renderer does not support natively is converted on unlock, which is no
+    // cheaper than the copy
+    auto formats_end = info.texture_formats + info.num_texture_formats;
+    return std::find(info.texture_formats, formats_end, SDL_PIXELFORMAT_ABGR8888) != formats_end;
+}
+
+bool Renderer::lockColorTexture() {
+    void* pixels;
+    int pitch;
+    const SDL_Rect render_rect{0, 0, _renderWidth, _renderHeight};
+    if (SDL_LockTexture(_colorBufferTexturePtr.get(), &render_rect, &pixels, &pitch) != 0)
+        return false;
+    if (pitch % sizeof(uint32_t) != 0) {
+        // rows are not addressable as pixels, stay with the copy from now on
+        SDL_UnlockTexture(_colorBufferTexturePtr.get());
+        _zeroCopyPresent = false;
+        return false;
+    }
+    _colorPixels = static_cast<uint32_t*>(pixels);
+    _colorPitch = pitch / static_cast<int>(sizeof(uint32_t));
+    return true;
+}
+
+void Renderer::unlockColorTexture() {
+    SDL_UnlockTexture(_colorBufferTexturePtr.get());
+    _colorPixels = _colorBuffer.data();
+    _colorPitch = _renderWidth;
 }
 
-void Renderer::clearColorBuffer(uint32_t color) {
-    std::fill(std::begin(_colorBuffer), std::end(_colorBuffer), color);
+void Renderer::clearColorBuffer(const Tile& tile, uint32_t color) {
+    for (int y{tile.minY}; y < tile.maxY; y++) {
+        kernels().fillColor(colorRow(y) + tile.minX, tile.maxX - tile.minX, color);
+    }
+}
+
+void Renderer::clearZBuffer(const Tile& tile) {
+    for (int y{tile.minY}; y < tile.maxY; y++) {
+        kernels().fillDepth(&_zBuffer[(_renderWidth * y) + tile.minX], tile.maxX - tile.minX,
+                            1.0f);
+    }
 }
 
 void Renderer::processInput() {
+    if (_headless)
+        return;
+    PROFILE_ZONE("processInput");
+    auto input = _stageTimer.measure(FrameStage::INPUT);
     SDL_Event event;
     while (SDL_PollEvent(&event)) {  // keep processing until queue is empty
         switch (event.type) {
@@ -602,64 +714,88 @@ void Renderer::processInput() {
                         _isRunning = false;
                         break;
                     case SDLK_RETURN:
+                        if (_streamingMesh)
+                            break;  // a streamed mesh is shown on its own
                         _currentObjPathIt++;
                         if (_currentObjPathIt == _pathes.end()) {
                             _currentObjPathIt = _pathes.begin();
                         }
-                        loadModelData(_currentObjPathIt->string());
+                        // keeps rendering the current model until the new one is loaded, a
+                        // cached model is shown on the next frame
+                        _pendingModelPath = _currentObjPathIt->string();
+                        _pendingModel = _modelLoader.cache().get(_pendingModelPath);
+                        requestModels();
                         break;
                     case SDLK_SPACE:
                         _pause = !_pause;
                         break;
                     case SDLK_c:
                         _enableFaceCulling = true;
+                        _settingsVersion++;
                         break;
                     case SDLK_x:
                         _enableFaceCulling = false;
+                        _settingsVersion++;
+                        break;
+                    case SDLK_o:
+                        _enableOcclusionCulling = !_enableOcclusionCulling;
+                        _settingsVersion++;
                         break;
                     case SDLK_1:
                         _currentRenderMode = RenderMode::WIREFRAME;
+                        _settingsVersion++;
                         break;
                     case SDLK_2:
                         _currentRenderMode = RenderMode::WIREFRAME_VERTICES;
+                        _settingsVersion++;
                         break;
                     case SDLK_3:
                         _currentRenderMode = RenderMode::RASTERIZE;
+                        _settingsVersion++;
                         break;
                     case SDLK_4:
                         _currentRenderMode = RenderMode::RASTERIZE_WIREFRAME;
+                        _settingsVersion++;
                         break;
                     case SDLK_5:
                         _currentRenderMode = RenderMode::TEXTURE;
+                        _settingsVersion++;
                         break;
                     case SDLK_6:
                         _currentRenderMode = RenderMode::TEXTURE_WIREFRAME;
+                        _settingsVersion++;
                         break;
                     case SDLK_UP:
                         // move camera forward
                         _camera._forwardVelocity = _camera._direction * 0.1;
                         _camera._position = _camera._position + _camera._forwardVelocity;
+                        _camera._version++;
                         break;
                     case SDLK_DOWN:
                         // move camera backward
                         _camera._forwardVelocity = _camera._direction * 0.1;
                         _camera._position = _camera._position - _camera._forwardVelocity;
+                        _camera._version++;
                         break;
                     case SDLK_LEFT:
                         // change yaw angle to look left
                         _camera._yaw -= 1.0 * _deltaTime;
+                        _camera._version++;
                         break;
                     case SDLK_RIGHT:
                         // change yaw angle to look right
                         _camera._yaw += 1.0 * _deltaTime;
+                        _camera._version++;
                         break;
                     case SDLK_w:
                         // change pitch angle to look up
                         _camera._pitch -= 1.0 * _deltaTime;
+                        _camera._version++;
                         break;
                     case SDLK_s:
                         // change pitch angle to look down
                         _camera._pitch += 1.0 * _deltaTime;
+                        _camera._version++;
                         break;
                     case SDLK_r:
                         _rotateModel = !_rotateModel;
@@ -724,18 +860,21 @@ Polygon Renderer::createPolygon(const Vector3f& a, const Vector3f& b, const Vect
     return Polygon{.vertices = {a, b, c}, .textcoords = {a_uv, b_uv, c_uv}, .num_of_vertices = 3};
 }
 
-void Renderer::clipPolygon(Polygon& polygon) {
-    clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::LEFT_PLANE);
-    clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::RIGHT_PLANE);
-    clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::TOP_PLANE);
-    clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::BOTTOM_PLANE);
-    clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::NEAR_PLANE);
-    clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::FAR_PLANE);
+bool Renderer::clipPolygon(Polygon& polygon) {
+    PROFILE_ZONE("clipPolygon");
+    // every plane is tested, also after an earlier one removed the polygon
+    bool clipped = clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::LEFT_PLANE);
+    clipped |= clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::RIGHT_PLANE);
+    clipped |= clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::TOP_PLANE);
+    clipped |= clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::BOTTOM_PLANE);
+    clipped |= clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::NEAR_PLANE);
+    clipped |= clipPolygonAgainstPlane(polygon, FRUSTUMPLANES::FAR_PLANE);
+    return clipped;
 }
 
-void Renderer::clipPolygonAgainstPlane(Polygon& polygon, FRUSTUMPLANES plane) {
+bool Renderer::clipPolygonAgainstPlane(Polygon& polygon, FRUSTUMPLANES plane) {
     if (polygon.num_of_vertices == 0)
-        return;
+        return false;
     Vector3f planePoint = frustumPlanes[plane]._point;
     Vector3f planeNormal = frustumPlanes[plane]._normal;
 
@@ -751,6 +890,7 @@ void Renderer::clipPolygonAgainstPlane(Polygon& polygon, FRUSTUMPLANES plane) {
 
     auto current_dot = 0.f;
     auto previous_dot = (*previousVertex - planePoint).dot(planeNormal);
+    bool clipped{false};
 
     while (currentVertex != &polygon.vertices[polygon.num_of_vertices]) {
         current_dot = (*currentVertex - planePoint).dot(planeNormal);
@@ -776,6 +916,8 @@ void Renderer::clipPolygonAgainstPlane(Polygon& polygon, FRUSTUMPLANES plane) {
             insideVertices[numberOfInsideVertices] = *currentVertex;
             insidetextCoords[numberOfInsideVertices] = *currentTextCoords;
             numberOfInsideVertices++;
+        } else {
+            clipped = true;
         }
         // Move to the next vertex
         previous_dot = current_dot;
@@ -795,6 +937,51 @@ void Renderer::clipPolygonAgainstPlane(Polygon& polygon, FRUSTUMPLANES plane) {
         ++i;
         polygon.num_of_vertices = numberOfInsideVertices;
     }
+    return clipped;
+}
+
+bool Renderer::isBoxInFrustum(const Eigen::Matrix4f& model_view, const Vector3f& min,
+                              const Vector3f& max) const {
+    std::array<Vector3f, 8> corners;
+    for (int i{0}; i < 8; i++) {
+        Vector4f corner{i & 1 ? max.x() : min.x(), i & 2 ? max.y() : min.y(),
+                        i & 4 ? max.z() : min.z(), 1.f};
+        corners[i] = (model_view * corner).head<3>();
+    }
+    // outside if all corners are behind the same plane, like clipPolygonAgainstPlane inside
+    // means a positive distance
+    for (const auto& plane : frustumPlanes) {
+        if (std::all_of(corners.begin(), corners.end(), [&](const Vector3f& corner) {
+                return (corner - plane._point).dot(plane._normal) <= 0;
+            }))
+            return false;
+    }
+    return true;
+}
+
+void Renderer::cullOccludedTriangles(std::vector<Triangle>& triangles) {
+    PROFILE_ZONE("cullOccludedTriangles");
+    // the biggest triangles on screen are the occluders
+    std::vector<std::pair<float, const Triangle*>> occluders;
+    for (const auto& triangle : triangles) {
+        auto area = _occlusionBuffer.area(triangle);
+        if (area >= MIN_OCCLUDER_AREA)
+            occluders.emplace_back(area, &triangle);
+    }
+    if (occluders.size() > MAX_NUM_OCCLUDERS) {
+        std::nth_element(occluders.begin(), occluders.begin() + MAX_NUM_OCCLUDERS, occluders.end(),
+                         [](const auto& a, const auto& b) { return a.first > b.first; });
+        occluders.resize(MAX_NUM_OCCLUDERS);
+    }
+
+    _occlusionBuffer.clear();
+    for (const auto& [area, occluder] : occluders) {
+        _occlusionBuffer.rasterizeOccluder(*occluder);
+    }
+
+    // an occluder is never behind its own farthest depth, so it survives its own test
+    std::erase_if(triangles,
+                  [this](const Triangle& triangle) { return _occlusionBuffer.isOccluded(triangle); });
 }
 
 std::vector<Triangle> Renderer::trianglesFromPolygons(const Polygon& polygon) {
@@ -826,8 +1013,8 @@ std::vector<Triangle> Renderer::trianglesFromPolygons(const Polygon& polygon) {
     return triangles_after_clipping;
 }
 
-Vector4f Renderer::project(Vector4f& point) { 
-    Vector4f vec = _persProjMatrix * Vector4f{point.x(), point.y(), point.z(), 1.0f};
+Vector4f Renderer::project(const TransformMatrix& projection, const Vector4f& point) {
+    Vector4f vec = transformPoint(projection, point.head<3>());
     
     // perform perspective divide
     // w_component = vec(3, 0) is the original Z value of the 3rd point before projection
@@ -852,23 +1039,34 @@ uint32_t Renderer::calculateLightIntensityColor(uint32_t original_color, float p
     return (a | (r & 0x00FF0000) | (g & 0x0000FF00) | (b & 0x000000FF)); // new color
 }
 
-void Renderer::loadPNGTextureData(const std::string& fileName) {
-    // Initialize SDL_image with PNG support if not already done
-    static bool sdl_image_initialized = false;
-    if (!sdl_image_initialized) {
+void Renderer::loadPNGTextureData(const std::string& fileName, ModelData& model) {
+    PROFILE_ZONE("loadPNGTextureData");
+    // pixels decoded before, SDL_image is not needed
+    if (loadTextureCache(fileName, model.texture, model.textureWidth, model.textureHeight))
+        return;
+    if (decodePNGTexture(fileName, model.texture, model.textureWidth, model.textureHeight))
+        saveTextureCache(fileName, model.texture, model.textureWidth, model.textureHeight);
+}
+
+bool Renderer::decodePNGTexture(const std::string& png_path, std::vector<uint32_t>& texture,
+                                int& width, int& height) {
+    // Initialize SDL_image with PNG support once, models are loaded on the loader thread
+    static const bool sdl_image_initialized = [] {
         int flags = IMG_INIT_PNG;
         if ((IMG_Init(flags) & flags) != flags) {
             std::cerr << "Failed to initialize SDL_image: " << IMG_GetError() << std::endl;
-            return;
+            return false;
         }
-        sdl_image_initialized = true;
-    }
+        return true;
+    }();
+    if (!sdl_image_initialized)
+        return false;
 
     // Load the PNG as an SDL surface
-    SDL_Surface* surface = IMG_Load(fileName.c_str());
+    SDL_Surface* surface = IMG_Load(png_path.c_str());
     if (!surface) {
         std::cerr << "Failed to load PNG file: " << IMG_GetError() << std::endl;
-        return;
+        return false;
     }
 
     // Ensure we have a consistent ABGR8888 pixel format
@@ -876,31 +1074,33 @@ void Renderer::loadPNGTextureData(const std::string& fileName) {
     SDL_FreeSurface(surface);
     if (!converted) {
         std::cerr << "Failed to convert surface to RGBA32: " << SDL_GetError() << std::endl;
-        return;
+        return false;
     }
 
     // Extract pixel data
-    _textureWidth = converted->w;
-    _textureHeight = converted->h;
-    _meshTextureBuffer.resize(_textureWidth * _textureHeight);
+    width = converted->w;
+    height = converted->h;
+    texture.resize(width * height);
 
-    std::memcpy(_meshTextureBuffer.data(), converted->pixels,
-                _textureWidth * _textureHeight * sizeof(uint32_t));
+    std::memcpy(texture.data(), converted->pixels, width * height * sizeof(uint32_t));
 
     SDL_FreeSurface(converted);
+    return true;
 }
 
 void Renderer::update() {
-    //this technique is prefered because SDL_TICKS_PASSED could lead to high CPU usage because of the while loop
-    //auto delayTime = _frameTargetTime - (SDL_GetTicks() - _previousFrameTime);
-    //if (delayTime > 0 && delayTime <= _frameTargetTime) {
-    //    SDL_Delay(delayTime);
-    //}
+    PROFILE_ZONE("update");
+    if (_headless) {
+        // offscreen frames are rendered as fast as possible, the animation steps as if at _fps
+        _deltaTime = 1.f / _fps;
+        _frameStart = std::chrono::steady_clock::now();
+    } else {
+        _deltaTime = static_cast<float>(_framePacer.wait());
+        _frameStart = std::chrono::steady_clock::now();
+    }
 
-    // this technique is better for consistent frame rate, and no high CPU usage observed on windows
-    while (!SDL_TICKS_PASSED(SDL_GetTicks(), _previousFrameTime + _frameTargetTime)) {}
-    _deltaTime = (SDL_GetTicks() - _previousFrameTime) / 1000.0;
-    _previousFrameTime = SDL_GetTicks();
+    // render() waited for the geometry of the last frame, nothing reads the mesh right now
+    swapLoadedModel();
 
     if (!_pause) {
         // Scale
@@ -916,6 +1116,8 @@ void Renderer::update() {
         _mesh.rotation.x() += (roationFactor * _deltaTime);
         _mesh.rotation.y() += (roationFactor * _deltaTime);
         _mesh.rotation.z() += (roationFactor * _deltaTime);
+        if (_rotateModel)
+            _meshVersion++;
 
         //create the view matrix
 
@@ -938,66 +1140,219 @@ void Renderer::update() {
         _worldMatrix.block<3, 3>(0, 0) = rotationMatrix * scaleMatrix;  // scaleMatrix is diagonal
         _worldMatrix.block<3, 1>(0, 3) = _mesh.translation;
 
-        for (auto& face : _mesh.faces) {
-            int i{0};
-            std::array<Vector3f, 3> face_vertices;
-            face_vertices[0] = _mesh.vertices[face.a];
-            face_vertices[1] = _mesh.vertices[face.b];
-            face_vertices[2] = _mesh.vertices[face.c];
-
-            for (auto& vertex : face_vertices) {
-                auto vec =
-                    _viewMatrix * _worldMatrix * Vector4f{vertex.x(), vertex.y(), vertex.z(), 1};
-                vertex = vec.block<3, 1>(0, 0);
+        if (_streamingMesh) {
+            // chunks that arrived since the last frame are drawn as well
+            const Eigen::Matrix4f model_view = _viewMatrix * _worldMatrix;
+            auto isVisible = [&](const Vector3f& min, const Vector3f& max) {
+                return isBoxInFrustum(model_view, min, max);
+            };
+            // offscreen frames are written once, they wait for the chunks they show
+            if (_streamingMesh->update(model_view, isVisible, _headless)) {
+                _meshParts = _streamingMesh->residentChunks();
+                _meshVersion++;
             }
+        }
 
-            // Face CUlling Check
-            auto [back_face, face_normal] = CullingCheck(face_vertices);
-            face.normal = face_normal;
-            if (_enableFaceCulling && back_face)
-                    continue;
-
-            // CLIPPING
-            // create polygon from a triangle
-            auto polygon = createPolygon(face_vertices[0], face_vertices[1], face_vertices[2],
-                                         face.a_uv, face.b_uv, face.c_uv);
-            clipPolygon(polygon);
-            // convert polygon to triangles
-            std::vector<Triangle> triangles_after_clipping = trianglesFromPolygons(polygon);
-            
-            for (auto& triangle : triangles_after_clipping) {
-                // loop over face vertecies to perform projection
-                Triangle projected_triangle;
-                i = 0;
-                for (auto& vertex : triangle.points) {
-                    auto projected_point = project(vertex);
-                    // scale into view
-                    projected_point.x() *= _windowWidth / 2.0;
-                    projected_point.y() *= _windowHeight / 2.0;
-                    // invert y axis to account for flipped screen y coordinates
-                    projected_point.y() *= -1;
-                    // translate to the center of the screen
-                    projected_point.x() += _windowWidth / 2.0;
-                    projected_point.y() += _windowHeight / 2.0;
-
-                    projected_triangle.points[i++] = projected_point;
-                    projected_triangle.text_coords[0] = triangle.text_coords[0];
-                    projected_triangle.text_coords[1] = triangle.text_coords[1];
-                    projected_triangle.text_coords[2] = triangle.text_coords[2];
-                    projected_triangle.normal = face.normal;
-                    projected_triangle.color = face.color;
-                }
-                _trianglesToRender.push_back(projected_triangle);
+        // nothing that the geometry depends on changed, the last triangles are still valid
+        SceneVersion version{_camera._version, _meshVersion, _settingsVersion};
+        if (_geometryVersion == version)
+            return;
+        _geometryVersion = version;
+
+        if (_pipelined) {
+            // build the next frame's triangles while render() rasterizes the previous ones,
+            // render() waits for it at the end of the frame
+            auto& jobSystem = JobSystem::instance();
+            _geometryJob = jobSystem.createJob([this] { buildTrianglesToRender(); });
+            jobSystem.run(_geometryJob);
+        } else {
+            buildTrianglesToRender();
+            // store the last frame triangles, incase of pause is hit we can still render the last frame
+            std::swap(_trianglesToRender, _lastTrianglesToRender);
+            _trianglesVersion++;
+        }
+    }
+}
+
+void Renderer::waitForGeometry() {
+    PROFILE_ZONE("waitForGeometry");
+    if (_geometryJob) {
+        JobSystem::instance().wait(_geometryJob);
+        _geometryJob.reset();
+        std::swap(_trianglesToRender, _lastTrianglesToRender);
+        _trianglesVersion++;
+    }
+}
+
+void Renderer::processFaces(const FaceBatch& batch, std::vector<Triangle>& triangles) {
+    PROFILE_ZONE("face loop");
+    triangles.clear();
+    // converted once per chunk for the selected math backend
+    const auto projection = toTransformMatrix(_persProjMatrix);
+    const auto* vertices = &_transformedVertices[batch.vertexOffset];
+    const bool quantized = batch.part->isQuantized();
+    Face decoded;
+    size_t clipped_polygons{0};
+    for (auto face_index{batch.begin}; face_index < batch.end; face_index++) {
+        if (quantized)
+            decoded = dequantizeFace(*batch.part, batch.part->quantizedFaces[face_index]);
+        const auto& face = quantized ? decoded : batch.part->faces[face_index];
+        int i{0};
+        std::array<Vector3f, 3> face_vertices;
+        face_vertices[0] = vertices[face.a];
+        face_vertices[1] = vertices[face.b];
+        face_vertices[2] = vertices[face.c];
+
+        // Face CUlling Check
+        auto [back_face, face_normal] = CullingCheck(face_vertices);
+        if (_enableFaceCulling && back_face)
+                continue;
+
+        // CLIPPING
+        // create polygon from a triangle
+        auto polygon = createPolygon(face_vertices[0], face_vertices[1], face_vertices[2],
+                                     face.a_uv, face.b_uv, face.c_uv);
+        if (clipPolygon(polygon))
+            clipped_polygons++;
+        // convert polygon to triangles
+        std::vector<Triangle> triangles_after_clipping = trianglesFromPolygons(polygon);
+        
+        for (auto& triangle : triangles_after_clipping) {
+            // loop over face vertecies to perform projection
+            Triangle projected_triangle;
+            i = 0;
+            for (auto& vertex : triangle.points) {
+                auto projected_point = project(projection, vertex);
+                // scale into view
+                projected_point.x() *= _renderWidth / 2.0;
+                projected_point.y() *= _renderHeight / 2.0;
+                // invert y axis to account for flipped screen y coordinates
+                projected_point.y() *= -1;
+                // translate to the center of the screen
+                projected_point.x() += _renderWidth / 2.0;
+                projected_point.y() += _renderHeight / 2.0;
+
+                projected_triangle.points[i++] = projected_point;
+                projected_triangle.text_coords[0] = triangle.text_coords[0];
+                projected_triangle.text_coords[1] = triangle.text_coords[1];
+                projected_triangle.text_coords[2] = triangle.text_coords[2];
+                projected_triangle.normal = face_normal;
+                projected_triangle.color = face.color;
             }
+            triangles.push_back(projected_triangle);
         }
-        // store the last frame triangles, incase of pause is hit we can still render the last frame
-        _lastTrianglesToRender = _trianglesToRender;
     }
+    _clippedPolygons.fetch_add(clipped_polygons, std::memory_order_relaxed);
 }
 
-void Renderer::render(double timer_value) {
-    clearColorBuffer(0xFF000000);
-    drawGrid();
+void Renderer::buildTrianglesToRender() {
+    PROFILE_ZONE("buildTrianglesToRender");
+    // every vertex is transformed once, faces sharing a vertex index into the same result. The
+    // parts (the whole model, or the resident chunks of a streamed mesh) get consecutive ranges
+    // of _transformedVertices
+    const Eigen::Matrix4f model_view = _viewMatrix * _worldMatrix;
+    std::vector<FaceBatch> vertex_batches;
+    std::vector<FaceBatch> face_batches;
+    size_t num_vertices{0};
+    for (const auto& part : _meshParts) {
+        auto part_vertices = part->vertexCount();
+        auto part_faces = part->faceCount();
+        for (size_t first{0}; first < part_vertices; first += VERTEX_CHUNK_SIZE) {
+            vertex_batches.push_back({part.get(), num_vertices, first,
+                                      std::min(first + VERTEX_CHUNK_SIZE, part_vertices)});
+        }
+        for (size_t first{0}; first < part_faces; first += FACE_CHUNK_SIZE) {
+            face_batches.push_back({part.get(), num_vertices, first,
+                                    std::min(first + FACE_CHUNK_SIZE, part_faces)});
+        }
+        num_vertices += part_vertices;
+    }
+    auto transform = _stageTimer.measure(FrameStage::TRANSFORM);
+    _transformedVertices.resize(num_vertices);
+    JobSystem::instance().parallelFor(vertex_batches.size(), 1, [&](size_t begin, size_t end) {
+        PROFILE_ZONE("transform");
+        for (auto index{begin}; index < end; index++) {
+            const auto& batch = vertex_batches[index];
+            auto* out = _transformedVertices[batch.vertexOffset + batch.begin].data();
+            if (batch.part->isQuantized()) {
+                kernels().transformQuantizedVertices(
+                    model_view.data(), &batch.part->quantizedVertices[batch.begin].x,
+                    batch.part->positionScale, out, batch.end - batch.begin);
+            } else {
+                kernels().transformVertices(model_view.data(),
+                                            batch.part->vertices[batch.begin].data(), out,
+                                            batch.end - batch.begin);
+            }
+        }
+    });
+    transform.stop();
+
+    // every chunk of faces is processed by its own job into its own list, the lists are joined in
+    // order afterwards so the result is the same as a sequential loop
+    auto cull_clip = _stageTimer.measure(FrameStage::CULL_CLIP);
+    auto numChunks = face_batches.size();
+    if (_chunkTriangles.size() < numChunks)
+        _chunkTriangles.resize(numChunks);
+    JobSystem::instance().parallelFor(numChunks, 1, [&](size_t begin, size_t end) {
+        for (auto chunk{begin}; chunk < end; chunk++) {
+            processFaces(face_batches[chunk], _chunkTriangles[chunk]);
+        }
+    });
+
+    _trianglesToRender.clear();
+    for (size_t chunk{0}; chunk < numChunks; chunk++) {
+        _trianglesToRender.insert(_trianglesToRender.end(), _chunkTriangles[chunk].begin(),
+                                  _chunkTriangles[chunk].end());
+    }
+
+    // wireframe only modes show hidden edges, so occluded triangles are only dropped when
+    // the triangles get filled
+    bool filled = _currentRenderMode != RenderMode::WIREFRAME &&
+                  _currentRenderMode != RenderMode::WIREFRAME_VERTICES;
+    if (_enableOcclusionCulling && filled)
+        cullOccludedTriangles(_trianglesToRender);
+
+#ifdef TRACY_ENABLE
+    size_t triangles_in{0};
+    for (const auto& part : _meshParts) {
+        triangles_in += part->faceCount();
+    }
+    PROFILE_PLOT("triangles in", triangles_in);
+#endif
+    PROFILE_PLOT("triangles out", _trianglesToRender.size());
+    PROFILE_PLOT("clipped polygons", _clippedPolygons.exchange(0, std::memory_order_relaxed));
+}
+
+void Renderer::binTriangles(const std::vector<Triangle>& triangles) {
+    PROFILE_ZONE("binTriangles");
+    auto numTiles = static_cast<size_t>((_renderHeight + TILE_HEIGHT - 1) / TILE_HEIGHT);
+    _tileBins.resize(numTiles);
+    for (auto& bin : _tileBins) {
+        bin.clear();
+    }
+    for (uint32_t i{0}; i < triangles.size(); i++) {
+        const auto& points = triangles[i].points;
+        auto min_y = std::min({points[0].y(), points[1].y(), points[2].y()});
+        auto max_y = std::max({points[0].y(), points[1].y(), points[2].y()});
+        // the DDA lines can round one row above the triangle and the vertex rects of
+        // WIREFRAME_VERTICES reach 3 pixels below it
+        auto first_tile = std::clamp((int)std::floor(min_y - 1) / TILE_HEIGHT, 0, (int)numTiles - 1);
+        auto last_tile = std::clamp((int)std::ceil(max_y + 3) / TILE_HEIGHT, 0, (int)numTiles - 1);
+        for (int tile{first_tile}; tile <= last_tile; tile++) {
+            _tileBins[tile].push_back(i);
+        }
+    }
+}
+
+void Renderer::rasterizeTile(size_t tileIndex) {
+    PROFILE_ZONE("rasterizeTile");
+    const Tile tile{.minX = 0,
+                    .minY = static_cast<int>(tileIndex) * TILE_HEIGHT,
+                    .maxX = _renderWidth,
+                    .maxY = std::min(static_cast<int>(tileIndex + 1) * TILE_HEIGHT, _renderHeight)};
+    clearColorBuffer(tile, 0xFF000000);
+    clearZBuffer(tile);
+    drawGrid(tile);
 
     bool wireframe = _currentRenderMode == RenderMode::WIREFRAME ||
                      _currentRenderMode == RenderMode::RASTERIZE_WIREFRAME ||
@@ -1012,40 +1367,118 @@ void Renderer::render(double timer_value) {
 
     bool showVertices = _currentRenderMode == RenderMode::WIREFRAME_VERTICES;
 
-    for (auto& triangle : _lastTrianglesToRender) {
+    for (auto triangle_index : _tileBins[tileIndex]) {
+        const auto& triangle = _lastTrianglesToRender[triangle_index];
         uint32_t wireframe_color{0xFF00FF00};  // default wirferame color is green
         if (raster) {
             auto light_intensity_factor = -(triangle.normal.dot(_lightDirection));
             auto color = calculateLightIntensityColor(triangle.color, light_intensity_factor);
-            rasterizeTriangle2(triangle, color);
+            rasterizeTriangle2(tile, triangle, color);
             wireframe_color = 0xFF000000;  // black
         }
-        if (textured && !_meshTextureBuffer.empty()) {
-            rasterizeTexturedTriangle(triangle, _meshTextureBuffer);
+        if (textured && !_mesh.data->texture.empty()) {
+            rasterizeTexturedTriangle(tile, triangle, _mesh.data->texture);
             wireframe_color = 0xFF000000;  // black
         } 
         if (showVertices) {
             // draw red vertices
-            drawRect(triangle.points[0].x(), triangle.points[0].y(), 3, 3, 0xFF0000FF);
-            drawRect(triangle.points[1].x(), triangle.points[1].y(), 3, 3, 0xFF0000FF);
-            drawRect(triangle.points[2].x(), triangle.points[2].y(), 3, 3, 0xFF0000FF);
+            drawRect(tile, triangle.points[0].x(), triangle.points[0].y(), 3, 3, 0xFF0000FF);
+            drawRect(tile, triangle.points[1].x(), triangle.points[1].y(), 3, 3, 0xFF0000FF);
+            drawRect(tile, triangle.points[2].x(), triangle.points[2].y(), 3, 3, 0xFF0000FF);
         }
         if (wireframe) {
-            drawTriangle(triangle, wireframe_color);
+            drawTriangle(tile, triangle, wireframe_color);
+        }
+    }
+    _rasterizedPixels.fetch_add(std::exchange(t_rasterizedPixels, 0), std::memory_order_relaxed);
+}
+
+void Renderer::render(double timer_value) {
+    PROFILE_ZONE("render");
+    // every tile clears and rasterizes its own rows of the color buffer and z-buffer, small tiles
+    // keep all workers busy when the model covers only the middle of the screen
+    // same triangles and same settings as the last rasterized frame, the color buffer is reused
+    std::pair version{_trianglesVersion, _settingsVersion};
+    if (_rasterizedVersion != version) {
+        auto bin = _stageTimer.measure(FrameStage::BIN);
+        binTriangles(_lastTrianglesToRender);
+        bin.stop();
+        auto raster = _stageTimer.measure(FrameStage::RASTER);
+        bool locked = _zeroCopyPresent && lockColorTexture();
+        JobSystem::instance().parallelFor(_tileBins.size(), 1, [this](size_t begin, size_t end) {
+            for (auto tile{begin}; tile < end; tile++) {
+                rasterizeTile(tile);
+            }
+        });
+        if (locked)
+            unlockColorTexture();
+        raster.stop();
+        _lastRasterizedPixels = _rasterizedPixels.exchange(0, std::memory_order_relaxed);
+        PROFILE_PLOT("pixels rasterized", _lastRasterizedPixels);
+        _rasterizedVersion = version;
+        // the texture already holds a zero-copy frame
+        _colorBufferChanged = !locked;
+    }
+    // a video has a frame per rendered frame, also when the color buffer was reused
+    if (_videoSink.isOpen())
+        _videoSink.submit(_colorBuffer);
+    if (!_headless)
+        presentFrame(timer_value);
+    waitForGeometry();
+
+    auto frame_time = std::chrono::steady_clock::now() - _frameStart;
+    _stageTimer.record(FrameStage::FRAME, frame_time);
+    if (_dynamicResolution) {
+        std::chrono::duration<double, std::milli> frame_ms = frame_time;
+        if (_resolutionScaler.addFrameTime(frame_ms.count()))
+            applyRenderScale(_resolutionScaler.scale());
+    }
+}
+
+void Renderer::applyRenderScale(float scale) {
+    PROFILE_ZONE("applyRenderScale");
+    int width = std::max(1, static_cast<int>(_windowWidth * scale + 0.5f));
+    int height = std::max(1, static_cast<int>(_windowHeight * scale + 0.5f));
+    if (width == _renderWidth && height == _renderHeight)
+        return;
+    // the last triangles are moved to the new resolution, so a paused frame stays right and the
+    // next pipelined frame rasterizes them before the geometry for the new size is done
+    float scale_x = static_cast<float>(width) / _renderWidth;
+    float scale_y = static_cast<float>(height) / _renderHeight;
+    for (auto& triangle : _lastTrianglesToRender) {
+        for (auto& point : triangle.points) {
+            point.x() *= scale_x;
+            point.y() *= scale_y;
         }
     }
+    _renderWidth = width;
+    _renderHeight = height;
+    _colorBuffer.resize(static_cast<size_t>(width) * height);
+    _zBuffer.resize(static_cast<size_t>(width) * height);
+    _colorPixels = _colorBuffer.data();
+    _colorPitch = width;
+    _occlusionBuffer.setScreenSize(width, height);
+    _trianglesVersion++;
+    _settingsVersion++;
+    std::cout << "-Render resolution: " << width << "x" << height << '\n';
+}
+
+void Renderer::presentFrame(double timer_value) {
+    PROFILE_ZONE("presentFrame");
+    // the HUD is drawn between the copy of the color buffer and the present
+    auto present_start = StageTimer::Clock::now();
     renderColorBuffer();
+    auto hud_start = StageTimer::Clock::now();
 
-    static std::string timer_value_ = std::move(std::to_string(timer_value));
-    static auto t1 = std::chrono::steady_clock::now().time_since_epoch();
-    auto t2 = std::chrono::steady_clock::now().time_since_epoch();
-    if (t2 - t1 > 0.5s) {
-        timer_value_ = std::move(std::to_string(timer_value));
-        t1 = t2;
+    // per instance, so renderers on different threads do not share the text
+    auto now = std::chrono::steady_clock::now();
+    if (_fpsText.empty() || now - _fpsTextTime > 0.5s) {
+        _fpsText = std::to_string(timer_value);
+        _fpsTextTime = now;
     }
     const Vector2i dims1{100, 30};
-    drawText(std::string("fps: "s + timer_value_), dims1, {(_windowWidth - dims1.x()) / 2, 40},
-             stoi(timer_value_) < _fps ? false : true);
+    drawText(std::string("fps: "s + _fpsText), dims1, {(_windowWidth - dims1.x()) / 2, 40},
+             stoi(_fpsText) < _fps ? false : true);
 
     const Vector2i dims2{40, 30};
     drawText("Profiles: ", {100, 30}, {40, 40}, false);
@@ -1058,86 +1491,131 @@ void Renderer::render(double timer_value) {
     drawText("c_Key: Culling.", {150, 30}, {40, 260},  _enableFaceCulling);
     drawText("x_Key: Disable Culling.", {200, 30}, {40, 290}, !_enableFaceCulling);
     drawText("Space_Key: Pause.", {200, 30}, {40, 320}, _pause);
+    drawText("o_Key: Occlusion Culling.", {220, 30}, {40, 350}, _enableOcclusionCulling);
+    auto hud_end = StageTimer::Clock::now();
 
     SDL_RenderPresent(_rendererPtr.get());
-    _trianglesToRender.clear();
-    std::fill(_zBuffer.begin(), _zBuffer.end(), 1.0f);
+    _stageTimer.record(FrameStage::HUD, hud_end - hud_start);
+    _stageTimer.record(FrameStage::PRESENT,
+                       (hud_start - present_start) + (StageTimer::Clock::now() - hud_end));
 }
 
-void Renderer::loadModelData(const std::string& file_Path) {
-    loadObjFileData(file_Path);
-    if (std::filesystem::exists(
-            std::filesystem::path(_currentObjPathIt->string()).replace_extension(".png"))) {
-        loadPNGTextureData(
-            std::filesystem::path(_currentObjPathIt->string()).replace_extension(".png").string());
-    } else {
-        _meshTextureBuffer.clear();
+void Renderer::setRenderMode(RenderMode mode) {
+    waitForGeometry();
+    _currentRenderMode = mode;
+    _settingsVersion++;
+}
+
+void Renderer::setRotateModel(bool rotate) {
+    _rotateModel = rotate;
+}
+
+void Renderer::setCamera(const Vector3f& position, float yaw, float pitch) {
+    _camera._position = position;
+    _camera._yaw = yaw;
+    _camera._pitch = pitch;
+    _camera._version++;
+}
+
+void Renderer::setModelRotation(const Vector3f& rotation) {
+    _mesh.rotation = rotation;
+    _meshVersion++;
+}
+
+void Renderer::setFrameRateLimit(double fps) {
+    _framePacer.setTargetRate(fps);
+    // an uncapped loop keeps the nominal rate for the offscreen animation step and the video
+    if (fps > 0.0) {
+        _fps = static_cast<uint32_t>(fps + 0.5);
+        _frameTargetTime = 1000.0 / fps;
     }
-    _trianglesToRender.resize(_mesh.faces.size());
-    _lastTrianglesToRender.resize(_mesh.faces.size());
-    _zBuffer.resize(_windowWidth * _windowHeight);
-    std::fill(std::begin(_zBuffer), std::end(_zBuffer), 1.0);
 }
 
-bool Renderer::loadObjFileData(const std::string& obj_file_path) {
-    FILE* file = fopen(obj_file_path.c_str(), "r");
-    if (!file) {
-        std::cerr << "Error opening file: " << obj_file_path << '\n';
-        return false;
+void Renderer::setDynamicResolution(bool enable) {
+    _dynamicResolution = enable;
+}
+
+void Renderer::setStageTimingsOutput(const std::string& path) {
+    _stageTimingsPath = path;
+}
+
+void Renderer::setVideoOutput(const std::string& path) {
+    _videoOutputPath = path;
+}
+
+bool Renderer::saveFrame(const std::string& path) const {
+    return writeImage(path, _colorBuffer, _renderWidth, _renderHeight);
+}
+
+void Renderer::setPipelined(bool pipelined) {
+    waitForGeometry();
+    _pipelined = pipelined;
+}
+
+void Renderer::loadModelData(const std::string& file_path, ModelData& model, bool optimize_mesh,
+                             bool quantize) {
+    loadObjFileData(file_path, model, optimize_mesh);
+    if (quantize)
+        quantizeModel(model);
+    auto png_path = std::filesystem::path(file_path).replace_extension(".png");
+    if (std::filesystem::exists(png_path)) {
+        loadPNGTextureData(png_path.string(), model);
     }
-    char line[1024];
+}
+
+void Renderer::requestModels() {
+    // the selected model first, then the one Enter switches to next
+    auto next = std::next(_currentObjPathIt);
+    if (next == _pathes.end())
+        next = _pathes.begin();
+    _modelLoader.request({_currentObjPathIt->string(), next->string()});
+}
 
-    std::vector<Vector2f> textureCoords;
-    if (!_mesh.vertices.empty() || !_mesh.faces.empty()) {
-        _mesh.vertices.clear();
-        _mesh.faces.clear();
+void Renderer::swapLoadedModel() {
+    if (_pendingModelPath.empty())
+        return;
+    if (!_pendingModel)
+        _pendingModel = _modelLoader.cache().peek(_pendingModelPath);
+    if (_pendingModel) {
+        _pendingModelPath.clear();
+        applyModel(std::move(_pendingModel));
     }
-    while (fgets(line, 1024, file)) {
-        Vector3f vertex;
-        // Vertex information
-        if (strncmp(line, "v ", 2) == 0) {
-            if (sscanf(line, "v %f %f %f", &vertex.x(), &vertex.y(), &vertex.z()) != 3) {
-                std::cerr << "Error parsing vertex line: " << line << '\n';
-                continue;
-            }
-            _mesh.vertices.push_back(vertex);
-        }
+}
 
-        Vector2f textureCoord;
-        //texture coordinates information
-        if (strncmp(line, "vt ", 3) == 0) {
-            if (sscanf(line, "vt %f %f", &textureCoord.x(), &textureCoord.y()) != 2) {
-                std::cerr << "Error parsing texture coordinates line: " << line << '\n';
-                continue;
-            }
-            textureCoords.push_back(textureCoord);
-        }
+void Renderer::applyModel(std::shared_ptr<const ModelData> model) {
+    _mesh.data = std::move(model);
+    _meshParts = {_mesh.data};
+    _trianglesToRender.clear();
+    _trianglesToRender.reserve(_mesh.data->faceCount());
+    _lastTrianglesToRender.clear();
+    _lastTrianglesToRender.reserve(_mesh.data->faceCount());
+    _zBuffer.resize(_renderWidth * _renderHeight);
+    std::fill(std::begin(_zBuffer), std::end(_zBuffer), 1.0);
+    _meshVersion++;
+    _trianglesVersion++;
+}
 
-        //int indices[9];  // 0-vertex_index, 1-texture_index, 2-normal_index,........,6-vertex_index, 7-texture_index, 8-normal_index
-        int vertex_indicies[3];
-        int texture_indicies[3];
-        int normal_indicies[3];
-        // Face information
-        if (strncmp(line, "f ", 2) == 0) {
-            if (sscanf(line, "f %d/%d/%d %d/%d/%d %d/%d/%d", &vertex_indicies[0],
-                       &texture_indicies[0], &normal_indicies[0], &vertex_indicies[1],
-                       &texture_indicies[1], &normal_indicies[1], &vertex_indicies[2],
-                       &texture_indicies[2], &normal_indicies[2]) != 9) {
-                std::cerr << "Error parsing face line: " << line << '\n';
-                continue;
-            }
-            Face face = {.a_uv = textureCoords[texture_indicies[0] - 1],
-                         .b_uv = textureCoords[texture_indicies[1] - 1],
-                         .c_uv = textureCoords[texture_indicies[2] - 1],
-                         .a = vertex_indicies[0] - 1,
-                         .b = vertex_indicies[1] - 1,
-                         .c = vertex_indicies[2] - 1,
-                         .color = 0xFFFFFFFF};
-            _mesh.faces.push_back(face);
-        }
+bool Renderer::loadObjFileData(const std::string& obj_file_path, ModelData& model,
+                               bool optimize_mesh) {
+    PROFILE_ZONE("loadObjFileData");
+    uint32_t cache_flags = optimize_mesh ? MESH_CACHE_VERTEX_CACHE_OPTIMIZED : 0;
+    if (loadMeshCache(obj_file_path, cache_flags, model.vertices, model.faces))
+        return true;  // already normalized (and optimized)
+    if (!loadObj(obj_file_path, model.vertices, model.faces)) {
+        std::cerr << "Error opening file: " << obj_file_path << '\n';
+        return false;
     }
-    normalizeModel(_mesh.vertices);
-    return 0 == fclose(file);
+    normalizeModel(model.vertices);
+    if (optimize_mesh) {
+        auto acmr = averageCacheMissRatio(model.faces, model.vertices.size());
+        optimizeVertexCache(model.faces, model.vertices.size());
+        reorderVerticesByFirstUse(model.vertices, model.faces);
+        std::cout << "-Vertex cache: " << std::filesystem::path(obj_file_path).filename().string()
+                  << " ACMR " << acmr << " -> "
+                  << averageCacheMissRatio(model.faces, model.vertices.size()) << '\n';
+    }
+    saveMeshCache(obj_file_path, cache_flags, model.vertices, model.faces);
+    return true;
 }
 
 std::pair<bool, Vector3f> Renderer::CullingCheck(const std::array<Vector3f, 3>& face_vertices) {
@@ -1203,34 +1681,61 @@ void Renderer::normalizeModel(std::vector<Vector3f>& vertices) {
     }
 }
 
+void Renderer::setStreamingBudget(size_t bytes) {
+    _streamingBudget = bytes;
+}
+
+void Renderer::setOptimizeMeshes(bool optimize) {
+    _optimizeMeshes = optimize;
+}
+
+void Renderer::setQuantizeMeshes(bool quantize) {
+    _quantizeMeshes = quantize;
+}
+
+bool Renderer::convertToStreamFile(const std::string& obj_file_path,
+                                   const std::string& stream_file_path) {
+    ModelData model;
+    if (!loadObjFileData(obj_file_path, model))
+        return false;
+    return writeStreamFile(stream_file_path, model);
+}
+
+void Renderer::setAssetCacheBudget(size_t bytes) {
+    _modelLoader.cache().setBudget(bytes);
+}
+
+AssetCacheStats Renderer::assetCacheStats() const {
+    return _modelLoader.cache().stats();
+}
+
 void Renderer::destroyWindow() {
+    waitForGeometry();
+    auto stats = assetCacheStats();
+    std::cout << "-Asset cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+              << stats.evictions << " evictions, " << (stats.bytes >> 20) << " of "
+              << (stats.budget >> 20) << " MB\n";
+    if (_streamingMesh) {
+        auto streaming = _streamingMesh->stats();
+        std::cout << "-Streaming: " << _streamingMesh->residentChunks().size() << " of "
+                  << _streamingMesh->chunkCount() << " chunks shown, " << streaming.entries
+                  << " resident, " << streaming.evictions << " evictions, "
+                  << (streaming.bytes >> 20) << " of " << (streaming.budget >> 20) << " MB\n";
+    }
+    if (_videoSink.isOpen()) {
+        _videoSink.close();
+        std::cout << "-Video: " << _videoSink.framesWritten() << " frames written, "
+                  << _videoSink.framesDropped() << " dropped\n";
+    }
+    if (!_stageTimingsPath.empty() && _stageTimer.save(_stageTimingsPath) &&
+        _stageTimingsPath != "-")
+        std::cout << "-Stage timings: " << _stageTimingsPath << '\n';
     // SDL_Quit();
 }
 
 void Renderer::drawText(std::string_view text, const Vector2i& dims, const Vector2i& pos,
                         bool enabledMode) {
-    SDL_Color color{};
-    if (enabledMode)
-        color = {0, 255, 0};
-    else 
-        color = {255, 255, 255};
-    SDL_Surface* surface = TTF_RenderText_Blended(_ttfTextRenerer, text.data(), color);
-    if (surface == nullptr) {
-        std::cout << "Unable to render text surface! SDL_ttf Error: " << TTF_GetError() << '\n';
-        return;
-    }
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(_rendererPtr.get(), surface);
-    if (texture == nullptr) {
-        SDL_FreeSurface(surface);
-        std::cout << "Unable to create texture from rendered text! SDL Error: " << SDL_GetError()
-                  << '\n';
-        return;
-    }
-
-    SDL_Rect renderQuad = {pos.x(), pos.y(), dims.x(), dims.y()};
-    SDL_RenderCopy(_rendererPtr.get(), texture, nullptr, &renderQuad);
-
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
+    PROFILE_ZONE("drawText");
+    SDL_Color color = enabledMode ? SDL_Color{0, 255, 0, 255} : SDL_Color{255, 255, 255, 255};
+    _glyphAtlas.draw(_rendererPtr.get(), text, {pos.x(), pos.y(), dims.x(), dims.y()}, color);
 }
\ No newline at end of file
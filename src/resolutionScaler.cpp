@@ -0,0 +1,31 @@
+//INTERNAL
+#include <resolutionScaler.hpp>
+
+bool ResolutionScaler::addFrameTime(double frame_ms) {
+    _blockMs += frame_ms;
+    if (++_blockFrames < RESOLUTION_SCALE_BLOCK_FRAMES)
+        return false;
+    double average = _blockMs / _blockFrames;
+    _blockFrames = 0;
+    _blockMs = 0.0;
+
+    auto previous_step = _step;
+    if (average > _budgetMs) {
+        if (_step + 1 < RESOLUTION_SCALE_STEPS.size())
+            _step++;
+        _raiseBlocks = 0;
+    } else if (_step > 0) {
+        // the raster work grows with the pixel count, the geometry does not, so this errs on
+        // the safe side
+        float ratio = RESOLUTION_SCALE_STEPS[_step - 1] / RESOLUTION_SCALE_STEPS[_step];
+        if (average * ratio * ratio < _budgetMs * RESOLUTION_RAISE_HEADROOM) {
+            if (++_raiseBlocks >= RESOLUTION_RAISE_BLOCKS) {
+                _step--;
+                _raiseBlocks = 0;
+            }
+        } else {
+            _raiseBlocks = 0;
+        }
+    }
+    return _step != previous_step;
+}
@@ -0,0 +1,225 @@
+//STL
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+//INTERNAL
+#include <meshCache.hpp>
+#include <meshQuantization.hpp>
+#include <streamingMesh.hpp>
+
+namespace {
+constexpr std::array<char, 4> STREAM_FILE_MAGIC{'R', 'S', 'T', 'M'};
+
+// followed by numChunks StreamChunk entries and the chunk payloads
+struct StreamHeader {
+    std::array<char, 4> magic;
+    uint32_t version;
+    uint32_t numChunks;
+    uint32_t reserved;
+};
+static_assert(sizeof(StreamHeader) == 16, "header layout is part of the file format");
+static_assert(sizeof(StreamChunk) == 40, "chunk table layout is part of the file format");
+
+// [begin, end) of the face order of one chunk
+struct FaceRange {
+    size_t begin;
+    size_t end;
+};
+
+std::vector<FaceRange> splitFaces(const ModelData& model, std::vector<uint32_t>& order) {
+    std::vector<Eigen::Vector3f> centroids(model.faces.size());
+    for (size_t i{0}; i < model.faces.size(); i++) {
+        const auto& face = model.faces[i];
+        centroids[i] =
+            (model.vertices[face.a] + model.vertices[face.b] + model.vertices[face.c]) / 3.f;
+    }
+    order.resize(model.faces.size());
+    std::iota(order.begin(), order.end(), 0u);
+
+    std::vector<FaceRange> chunks;
+    std::vector<FaceRange> pending;
+    if (!order.empty())
+        pending.push_back({0, order.size()});
+    while (!pending.empty()) {
+        auto range = pending.back();
+        pending.pop_back();
+        if (range.end - range.begin <= STREAM_CHUNK_FACES) {
+            chunks.push_back(range);
+            continue;
+        }
+        Eigen::Vector3f min = centroids[order[range.begin]];
+        Eigen::Vector3f max = min;
+        for (auto i{range.begin}; i < range.end; i++) {
+            min = min.cwiseMin(centroids[order[i]]);
+            max = max.cwiseMax(centroids[order[i]]);
+        }
+        int axis;
+        (max - min).maxCoeff(&axis);
+        auto middle = range.begin + (range.end - range.begin) / 2;
+        std::nth_element(order.begin() + range.begin, order.begin() + middle,
+                         order.begin() + range.end, [&](uint32_t a, uint32_t b) {
+                             return centroids[a][axis] < centroids[b][axis];
+                         });
+        pending.push_back({middle, range.end});
+        pending.push_back({range.begin, middle});
+    }
+    return chunks;
+}
+}  // namespace
+
+bool writeStreamFile(const std::string& path, const ModelData& model) {
+    std::vector<uint32_t> order;
+    auto ranges = splitFaces(model, order);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    StreamHeader header{.magic = STREAM_FILE_MAGIC,
+                        .version = STREAM_FILE_VERSION,
+                        .numChunks = static_cast<uint32_t>(ranges.size()),
+                        .reserved = 0};
+    std::vector<StreamChunk> table(ranges.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(StreamChunk));
+
+    // chunk local vertex index of every model vertex, valid where the stamp is the chunk index
+    std::vector<uint32_t> stamps(model.vertices.size(), UINT32_MAX);
+    std::vector<int> local_index(model.vertices.size());
+    std::vector<Eigen::Vector3f> vertices;
+    std::vector<Face> faces;
+    std::vector<char> payload;
+    uint64_t offset = sizeof(header) + table.size() * sizeof(StreamChunk);
+    for (uint32_t chunk{0}; chunk < ranges.size(); chunk++) {
+        vertices.clear();
+        faces.clear();
+        auto localVertex = [&](int index) {
+            if (stamps[index] != chunk) {
+                stamps[index] = chunk;
+                local_index[index] = static_cast<int>(vertices.size());
+                vertices.push_back(model.vertices[index]);
+            }
+            return local_index[index];
+        };
+        for (auto i{ranges[chunk].begin}; i < ranges[chunk].end; i++) {
+            Face face = model.faces[order[i]];
+            face.a = localVertex(face.a);
+            face.b = localVertex(face.b);
+            face.c = localVertex(face.c);
+            faces.push_back(face);
+        }
+
+        auto& entry = table[chunk];
+        Eigen::Vector3f min = vertices.front();
+        Eigen::Vector3f max = min;
+        for (const auto& vertex : vertices) {
+            min = min.cwiseMin(vertex);
+            max = max.cwiseMax(vertex);
+        }
+        entry.min = {min.x(), min.y(), min.z()};
+        entry.max = {max.x(), max.y(), max.z()};
+        entry.offset = offset;
+        entry.numVertices = static_cast<uint32_t>(vertices.size());
+        entry.numFaces = static_cast<uint32_t>(faces.size());
+
+        packMeshPayload(vertices, faces, payload);
+        out.write(payload.data(), payload.size());
+        offset += payload.size();
+    }
+    out.seekp(sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(StreamChunk));
+    if (!out) {
+        std::cerr << "Failed to write stream file: " << path << '\n';
+        return false;
+    }
+    return true;
+}
+
+StreamingMesh::StreamingMesh(size_t budget, bool quantize)
+    : _budget(budget),
+      _quantize(quantize),
+      _loader([this](const std::string& key, ModelData& chunk) { loadChunk(key, chunk); }) {
+    _loader.cache().setBudget(budget);
+}
+
+bool StreamingMesh::open(const std::string& path) {
+    _file = MappedFile(path, MappedFile::Access::RANDOM);
+    if (!_file.isOpen() || _file.size() < sizeof(StreamHeader))
+        return false;
+    StreamHeader header;
+    std::memcpy(&header, _file.data(), sizeof(header));
+    size_t table_end = sizeof(header) + size_t{header.numChunks} * sizeof(StreamChunk);
+    if (header.magic != STREAM_FILE_MAGIC || header.version != STREAM_FILE_VERSION ||
+        _file.size() < table_end)
+        return false;
+
+    _chunks.resize(header.numChunks);
+    std::memcpy(_chunks.data(), _file.data() + sizeof(header), _chunks.size() * sizeof(StreamChunk));
+    for (const auto& chunk : _chunks) {
+        if (chunk.offset < table_end ||
+            chunk.offset + meshPayloadSize(chunk.numVertices, chunk.numFaces) > _file.size())
+            return false;
+    }
+    _keys.resize(_chunks.size());
+    for (size_t i{0}; i < _keys.size(); i++) {
+        _keys[i] = std::to_string(i);
+    }
+    return true;
+}
+
+bool StreamingMesh::update(const Eigen::Matrix4f& model_view, const BoxVisibleFunc& isVisible,
+                           bool wait_for_resident) {
+    // squared view space distance of the chunk center, nearest chunks are loaded first
+    std::vector<std::pair<float, size_t>> visible;
+    for (size_t i{0}; i < _chunks.size(); i++) {
+        Eigen::Vector3f min(_chunks[i].min.data());
+        Eigen::Vector3f max(_chunks[i].max.data());
+        if (!isVisible(min, max))
+            continue;
+        Eigen::Vector3f center = (min + max) / 2.f;
+        visible.emplace_back((model_view * center.homogeneous()).head<3>().squaredNorm(), i);
+    }
+    std::sort(visible.begin(), visible.end());
+
+    std::vector<std::string> wanted;
+    size_t bytes{0};
+    for (auto [distance, index] : visible) {
+        bytes += _chunks[index].byteSize(_quantize);
+        if (bytes > _budget && !wanted.empty())
+            break;
+        wanted.push_back(_keys[index]);
+    }
+    _loader.request(wanted);
+    // the wanted chunks are pinned, none of them is evicted while waiting
+    if (wait_for_resident)
+        _loader.waitUntilIdle();
+
+    std::vector<std::shared_ptr<const ModelData>> resident;
+    for (const auto& key : wanted) {
+        if (auto chunk = _loader.cache().peek(key))
+            resident.push_back(std::move(chunk));
+    }
+    bool changed = resident != _resident;
+    _resident = std::move(resident);
+    return changed;
+}
+
+void StreamingMesh::loadChunk(const std::string& key, ModelData& chunk) {
+    const auto& entry = _chunks[std::stoul(key)];
+    auto payload_size = meshPayloadSize(entry.numVertices, entry.numFaces);
+    unpackMeshPayload(_file.data() + entry.offset, entry.numVertices, entry.numFaces,
+                      chunk.vertices, chunk.faces);
+    // the decoded chunk is used from now on, its pages of the mapping can go
+    _file.release(entry.offset, payload_size);
+
+    auto num_vertices = static_cast<int>(entry.numVertices);
+    auto valid = [&](int index) { return index >= 0 && index < num_vertices; };
+    if (!std::all_of(chunk.faces.begin(), chunk.faces.end(), [&](const Face& face) {
+            return valid(face.a) && valid(face.b) && valid(face.c);
+        })) {
+        std::cerr << "Invalid face indices in stream chunk: " << key << '\n';
+        chunk.vertices.clear();
+        chunk.faces.clear();
+    } else if (_quantize) {
+        quantizeModel(chunk);
+    }
+}
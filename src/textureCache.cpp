@@ -0,0 +1,76 @@
+//STL
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+//INTERNAL
+#include <mappedFile.hpp>
+#include <meshCache.hpp>
+#include <textureCache.hpp>
+
+namespace {
+constexpr std::array<char, 4> TEXTURE_CACHE_MAGIC{'R', 'T', 'E', 'X'};
+
+// followed by width * height ABGR8888 pixels, row by row
+struct TextureCacheHeader {
+    std::array<char, 4> magic;
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t payloadHash;
+    uint32_t width;
+    uint32_t height;
+};
+static_assert(sizeof(TextureCacheHeader) == 40, "header layout is part of the file format");
+}  // namespace
+
+std::string textureCachePath(const std::string& png_path) {
+    return std::filesystem::path(png_path).replace_extension(".rtex").string();
+}
+
+bool loadTextureCache(const std::string& png_path, std::vector<uint32_t>& texture, int& width,
+                      int& height) {
+    uint64_t source_size;
+    int64_t source_time;
+    if (!sourceFileStamp(png_path, source_size, source_time))
+        return false;
+    MappedFile file(textureCachePath(png_path));
+    if (!file.isOpen() || file.size() < sizeof(TextureCacheHeader))
+        return false;
+
+    TextureCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != TEXTURE_CACHE_MAGIC || header.version != TEXTURE_CACHE_VERSION ||
+        header.sourceSize != source_size || header.sourceTime != source_time)
+        return false;
+    const char* payload = file.data() + sizeof(header);
+    size_t payload_size = size_t{header.width} * header.height * sizeof(uint32_t);
+    if (file.size() != sizeof(header) + payload_size ||
+        fnv1aHash(payload, payload_size) != header.payloadHash)
+        return false;
+
+    width = static_cast<int>(header.width);
+    height = static_cast<int>(header.height);
+    texture.resize(size_t{header.width} * header.height);
+    std::memcpy(texture.data(), payload, payload_size);
+    return true;
+}
+
+bool saveTextureCache(const std::string& png_path, const std::vector<uint32_t>& texture, int width,
+                      int height) {
+    TextureCacheHeader header{.magic = TEXTURE_CACHE_MAGIC,
+                              .version = TEXTURE_CACHE_VERSION,
+                              .width = static_cast<uint32_t>(width),
+                              .height = static_cast<uint32_t>(height)};
+    if (!sourceFileStamp(png_path, header.sourceSize, header.sourceTime))
+        return false;
+    size_t payload_size = texture.size() * sizeof(uint32_t);
+    header.payloadHash = fnv1aHash(texture.data(), payload_size);
+
+    auto cache_path = textureCachePath(png_path);
+    if (!writeSidecarFile(cache_path, &header, sizeof(header), texture.data(), payload_size)) {
+        std::cerr << "Failed to write texture cache: " << cache_path << '\n';
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+//STL
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+//INTERNAL
+#include <timer.hpp>
+
+void StageTimer::record(FrameStage stage, Clock::duration time) {
+    auto& samples = _stages[static_cast<size_t>(stage)];
+    // every caller gets its own slot, a reader may still see the sample this one replaces
+    auto index = samples.count.fetch_add(1, std::memory_order_relaxed);
+    samples.ms[index % STAGE_TIMING_SAMPLES].store(
+        std::chrono::duration<float, std::milli>(time).count(), std::memory_order_relaxed);
+}
+
+StageStats StageTimer::stats(FrameStage stage) const {
+    const auto& samples = _stages[static_cast<size_t>(stage)];
+    auto count = samples.count.load(std::memory_order_relaxed);
+    std::vector<float> window(std::min<uint64_t>(count, STAGE_TIMING_SAMPLES));
+    if (window.empty())
+        return {0, 0.0, 0.0, 0.0, 0.0};
+    for (size_t i{0}; i < window.size(); i++) {
+        window[i] = samples.ms[i].load(std::memory_order_relaxed);
+    }
+    std::sort(window.begin(), window.end());
+    // nearest rank
+    auto percentile = [&](double p) {
+        auto rank = static_cast<size_t>(std::ceil(p * window.size()));
+        return static_cast<double>(window[std::max<size_t>(rank, 1) - 1]);
+    };
+    return {count, percentile(0.5), percentile(0.95), percentile(0.99), window.back()};
+}
+
+bool StageTimer::save(const std::string& path) const {
+    std::ofstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file) {
+            std::cerr << "Failed to write the stage timings: " << path << '\n';
+            return false;
+        }
+    }
+    std::ostream& out = path == "-" ? std::cout : file;
+    bool json = std::filesystem::path(path).extension() == ".json";
+    out << (json ? "{\n" : "stage,samples,p50_ms,p95_ms,p99_ms,max_ms\n");
+    for (size_t stage{0}; stage < FRAME_STAGE_COUNT; stage++) {
+        auto stage_stats = stats(static_cast<FrameStage>(stage));
+        if (json) {
+            out << "  \"" << FRAME_STAGE_NAMES[stage] << "\": {\"samples\": " << stage_stats.samples
+                << ", \"p50_ms\": " << stage_stats.p50 << ", \"p95_ms\": " << stage_stats.p95
+                << ", \"p99_ms\": " << stage_stats.p99 << ", \"max_ms\": " << stage_stats.max
+                << (stage + 1 < FRAME_STAGE_COUNT ? "},\n" : "}\n");
+        } else {
+            out << FRAME_STAGE_NAMES[stage] << ',' << stage_stats.samples << ','
+                << stage_stats.p50 << ',' << stage_stats.p95 << ',' << stage_stats.p99 << ','
+                << stage_stats.max << '\n';
+        }
+    }
+    if (json)
+        out << "}\n";
+    return static_cast<bool>(out);
+}
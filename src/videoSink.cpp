@@ -0,0 +1,146 @@
+//STL
+#include <algorithm>
+#include <iostream>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+//INTERNAL
+#include <kernels.hpp>
+#include <profiling.hpp>
+#include <videoSink.hpp>
+
+VideoSink::~VideoSink() {
+    close();
+}
+
+bool VideoSink::open(const std::string& path, int width, int height, int fps,
+                     bool drop_when_full) {
+    close();
+    if (path == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        _file = stdout;
+    } else {
+        _file = std::fopen(path.c_str(), "wb");
+    }
+    if (!_file) {
+        std::cerr << "Failed to open video output: " << path << '\n';
+        return false;
+    }
+    // 420jpeg: the chroma samples sit in the middle of their 2x2 block, like the averages
+    std::fprintf(_file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", width,
+                 height, fps);
+
+    _width = width;
+    _height = height;
+    _dropWhenFull = drop_when_full;
+    auto chroma_size = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+    _planes.resize(static_cast<size_t>(width) * height + 2 * chroma_size);
+    _queued.clear();
+    _free.assign(VIDEO_SINK_QUEUE_FRAMES,
+                 std::vector<uint32_t>(static_cast<size_t>(width) * height));
+    _closing = false;
+    _failed = false;
+    _framesWritten = 0;
+    _framesDropped = 0;
+    _thread = std::thread(&VideoSink::writeFrames, this);
+    return true;
+}
+
+void VideoSink::submit(const std::vector<uint32_t>& frame) {
+    if (!_file || frame.size() != static_cast<size_t>(_width) * _height)
+        return;
+    std::unique_lock lock(_mutex);
+    if (_free.empty() && _dropWhenFull) {
+        _framesDropped++;
+        return;
+    }
+    _bufferFreed.wait(lock, [this] { return !_free.empty() || _failed; });
+    if (_failed)
+        return;
+    auto buffer = std::move(_free.back());
+    _free.pop_back();
+    // the copy does not need the lock, the sink only takes queued buffers
+    lock.unlock();
+    std::copy(frame.begin(), frame.end(), buffer.begin());
+    lock.lock();
+    _queued.push_back(std::move(buffer));
+    _frameQueued.notify_one();
+}
+
+void VideoSink::close() {
+    if (!_file)
+        return;
+    {
+        std::lock_guard lock(_mutex);
+        _closing = true;
+    }
+    _frameQueued.notify_one();
+    _thread.join();
+    if (_file == stdout)
+        std::fflush(_file);
+    else
+        std::fclose(_file);
+    _file = nullptr;
+}
+
+size_t VideoSink::framesWritten() const {
+    std::lock_guard lock(_mutex);
+    return _framesWritten;
+}
+
+size_t VideoSink::framesDropped() const {
+    std::lock_guard lock(_mutex);
+    return _framesDropped;
+}
+
+void VideoSink::writeFrames() {
+    PROFILE_THREAD_NAME("Video writer");
+    while (true) {
+        std::vector<uint32_t> frame;
+        {
+            std::unique_lock lock(_mutex);
+            _frameQueued.wait(lock, [this] { return !_queued.empty() || _closing; });
+            if (_queued.empty())
+                return;
+            frame = std::move(_queued.front());
+            _queued.pop_front();
+        }
+        convertFrame(frame);
+        bool written = std::fputs("FRAME\n", _file) >= 0 &&
+                       std::fwrite(_planes.data(), 1, _planes.size(), _file) == _planes.size();
+        {
+            std::lock_guard lock(_mutex);
+            _free.push_back(std::move(frame));
+            if (written)
+                _framesWritten++;
+            else
+                _failed = true;
+        }
+        _bufferFreed.notify_one();
+        if (!written) {
+            std::cerr << "Failed to write video frame\n";
+            return;
+        }
+    }
+}
+
+void VideoSink::convertFrame(const std::vector<uint32_t>& frame) {
+    const auto& convert = kernels().convertToI420;
+    auto chroma_width = (_width + 1) / 2;
+    uint8_t* y_plane = _planes.data();
+    uint8_t* u_plane = y_plane + static_cast<size_t>(_width) * _height;
+    uint8_t* v_plane = u_plane + static_cast<size_t>(chroma_width) * ((_height + 1) / 2);
+    for (int y{0}; y < _height; y += 2) {
+        // the last row of an odd height is its own pair
+        int next = std::min(y + 1, _height - 1);
+        convert(frame.data() + static_cast<size_t>(y) * _width,
+                frame.data() + static_cast<size_t>(next) * _width, _width,
+                y_plane + static_cast<size_t>(y) * _width,
+                y_plane + static_cast<size_t>(next) * _width,
+                u_plane + static_cast<size_t>(y / 2) * chroma_width,
+                v_plane + static_cast<size_t>(y / 2) * chroma_width);
+    }
+}